@@ -10,6 +10,10 @@
 #define N_CHANNELS 8
 #define B_BUS_ADDR 0x00002100
 
+#define HDMA_LINES 0xF0 // lines 0-239 can run HDMA, the last is only reached with overscan
+#define HDMA_PAGES 8 // pages one channel's program can depend on
+#define HDMA_SETUP_CYCLES 18
+
 enum Pattern
 {
 	P0,
@@ -35,6 +39,27 @@ enum Direction
 	B_to_A
 };
 
+// everything about a channel that decides what its next HDMA line does
+struct HDMA_state
+{
+	uint32_t table_addr; // A1Bx:A2Ax
+	uint32_t indirect_addr; // DASBx:DASx
+	uint8_t param_byte;
+	uint8_t B_addr;
+	uint8_t line_counter; // NLTRx
+	uint8_t do_transfer;
+	uint8_t terminated;
+};
+
+// one precompiled HDMA line, state is what the channel looks like before it runs
+struct HDMA_line
+{
+	struct HDMA_state state;
+	uint8_t bytes[4];
+	uint8_t count;
+	uint8_t cycles;
+};
+
 struct DMA
 {
 	int MDMA_enable[N_CHANNELS];
@@ -53,15 +78,21 @@ struct DMA
 	uint8_t HDMA_scanline_counter[N_CHANNELS];
 	int HDMA_indirect[N_CHANNELS];
 	int HDMA_repeat[N_CHANNELS];
-
-
-	int HDMA_channels_finished[8];
-	int HDMA_need_indirect[8];
+	int HDMA_do_transfer[N_CHANNELS];
+	int HDMA_terminated[N_CHANNELS];
+
+	// HDMA_LINES + 1 entries per channel, lines [program_start, program_end) are valid
+	// while the channel's state and every page in HDMA_pages match what they were compiled from
+	struct HDMA_line *HDMA_program[N_CHANNELS];
+	int HDMA_program_start[N_CHANNELS];
+	int HDMA_program_end[N_CHANNELS];
+	uint32_t *HDMA_pages[N_CHANNELS][HDMA_PAGES];
+	uint32_t HDMA_page_generation[N_CHANNELS][HDMA_PAGES];
+	int HDMA_page_count[N_CHANNELS];
 
 	int MDMA_channel_over;
 	int new_MDMA_transfer;
 
-	int HDMA_allowed;
 	int queued_cycles;
 	int elapsed_cycles;
 	int dma_active;
@@ -72,5 +103,7 @@ struct DMA
 
 void init_DMA(struct data_bus *data_bus);
 void DMA_transfers(struct data_bus *data_bus, int alignment);
+void init_HDMA_frame(struct data_bus *data_bus);
+void run_HDMA_line(struct data_bus *data_bus, int line);
 
 #endif // DMA_H
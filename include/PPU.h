@@ -11,9 +11,33 @@
 #define HIDE_DOTS 44
 #define HIDE_LINES 2
 
+#define HBLANK_CYCLES 68
+#define REFRESH_DOT (536 / 4)
+
 #define VISIBLE_DOTS 512
 #define VISIBLE_LINES 448
 
+#define LINE_PIXELS 256
+
+#define FRAME_LINES 224
+#define FRAME_OVERSCAN_LINES 239
+#define FRAME_MAX_WIDTH VISIBLE_DOTS
+#define FRAME_MAX_HEIGHT (FRAME_OVERSCAN_LINES * 2)
+
+#define BG_LAYERS 4
+#define OBJ_LAYER 4
+#define BACKDROP_LAYER 5
+#define COLOR_WINDOW 5
+
+#define NO_COLOR_MATH 0x80 // OBJ palettes 0-3
+#define COLOR_MATH_ENABLE 0x01
+#define COLOR_MATH_HALF 0x02
+
+#define OAM_SPRITES 128
+#define LINE_SPRITES 32
+#define LINE_TILES 34
+#define SPRITE_LINES 256
+
 #define TILEMAP_BASE_SIDE 32
 #define TILESET_ROW_SIZE 16
 
@@ -25,18 +49,42 @@
 #define OAM_HTABLE_BYTES 32
 #define CGRAM_WORDS 256
 
+#define VRAM_ADDR_MASK 0x7FFF
+#define BGR555_COLORS 0x8000
+
+#define HOST_PIXEL_FORMAT SDL_PIXELFORMAT_XRGB8888
+#define HOST_RED_SHIFT 16
+#define HOST_GREEN_SHIFT 8
+#define HOST_BLUE_SHIFT 0
+#define TILE_CACHE_VIEWS 3 // 2bpp, 4bpp, 8bpp
+#define TILE_PIXELS 64
+
 struct PPU_memory
 {
 	uint8_t *VRAM;
 	uint8_t *OAM_low_table;
 	uint8_t *OAM_high_table;
 	uint8_t *CGRAM;
+	uint16_t *palette; // CGRAM as words, kept in sync by write_CGRAM_word
+
+	// VRAM decoded to one byte per pixel, a character is only decoded again after it's written to
+	uint8_t *tile_cache[TILE_CACHE_VIEWS];
+	uint8_t *tile_dirty[TILE_CACHE_VIEWS];
 };
 
 struct S_PPU
 {
 	struct PPU *ppu;
 	struct PPU_memory *memory;
+
+	// FRAME_MAX_WIDTH x FRAME_MAX_HEIGHT in HOST_PIXEL_FORMAT, the finished frame is the top left frame_width x frame_height
+	uint32_t *frame_buffer;
+	int frame_width;
+	int frame_height;
+	int frame_hires;
+	uint8_t frame_line_hires[FRAME_MAX_HEIGHT]; // the row already holds 512 pixels, drawn hi-res or doubled
+
+	int skip_render; // only the machine state is wanted, sprites are still evaluated for STAT77
 };
 
 enum sprite_sizes
@@ -66,13 +114,11 @@ enum window_regions
 	Everywhere
 };
 
-typedef struct 
+struct layer_pixels
 {
-	uint8_t r;
-	uint8_t g;
-	uint8_t b;
-	uint8_t a;
-} Color_t;
+	uint16_t color[VISIBLE_DOTS]; // BGR555
+	uint8_t priority[VISIBLE_DOTS]; // 0 -> transparent, otherwise priority + 1
+};
 
 struct PPU
 {
@@ -82,6 +128,7 @@ struct PPU
 	uint8_t name_select;
 	uint8_t name_base_addr;
 	uint16_t OAM_addr; // 15-bit, bit 15 = priority rotation
+	uint8_t first_sprite; // priority rotation
 	uint8_t OAM_write;
 	uint8_t OAM_latch;
 	uint8_t BG_mode;
@@ -147,6 +194,10 @@ struct PPU
 
 		uint16_t center_X;
 		uint16_t center_Y;
+
+		uint16_t horizontal_offset;
+		uint16_t vertical_offset;
+		uint8_t latch; // shared by M7A-M7Y, M7HOFS and M7VOFS
 	} M7_matrices;
 	uint8_t CGRAM_addr;
 	uint8_t CGRAM_write;
@@ -163,6 +214,11 @@ struct PPU
 		int enable_OBJ_window_1;
 		int enable_BGn_window_2[4];
 		int enable_OBJ_window_2;
+
+		int invert_color_window_1;
+		int invert_color_window_2;
+		int enable_color_window_1;
+		int enable_color_window_2;
 	} window_select;
 	struct 
 	{
@@ -181,6 +237,8 @@ struct PPU
 	int BGn_sub_enable[4];
 	int apply_window_OBJ_main;
 	int apply_window_BGn_main[4];
+	int apply_window_OBJ_sub;
+	int apply_window_BGn_sub[4];
 	enum window_regions subscreen_transparent_region;
 	enum window_regions mainscreen_black_region;
 	int addend; // 0 -> fixed color, 1 -> subscreen
@@ -224,15 +282,44 @@ struct PPU
 	uint8_t PPU1_bus;
 	uint8_t PPU2_bus;
 
-	int x, y;
-	int active_scan;
-	int active_x, active_y;
-	int queued_cycles;
+	int x, y; // beam, 2 a dot and 2 a line, placed from the master clock by sync_PPU
 	int frame_finished;
+
+	int render_x; // next pixel of the line buffer that hasn't been rendered
+	int render_line;
+	uint32_t line_buffer[VISIBLE_DOTS]; // HOST_PIXEL_FORMAT, 512 pixels on hi-res lines, otherwise 256
+	int line_hires;
+
+	// every BGR555 color in HOST_PIXEL_FORMAT at host_brightness
+	uint32_t *host_colors;
+	int host_brightness;
+	struct layer_pixels layer_pixels[OBJ_LAYER + 1];
+
+	// sprites covering each line in OAM order, rebuilt when OAM or OBJSEL change
+	int OAM_dirty;
+	uint8_t line_sprite_count[SPRITE_LINES];
+	uint8_t line_sprites[SPRITE_LINES][OAM_SPRITES];
 };
 
 void init_s_ppu(struct S_PPU *s_ppu);
-void ppu_dot(struct data_bus *data_bus, SDL_Surface *frame_buffer);
+int vblank_line(struct PPU *ppu);
+int dot_cycles(int x, int y);
+int dot_offset(int x, int y);
+int line_cycles(int y);
+int offset_dot(int offset, int y);
+void advance_beam(int *x, int *y);
+int next_event_dot(struct data_bus *data_bus);
+void beam_events(struct data_bus *data_bus);
+
+void invalidate_tile(struct data_bus *data_bus, uint16_t addr);
+
+void start_line(struct data_bus *data_bus);
+void flush_line(struct data_bus *data_bus);
+void finish_line(struct data_bus *data_bus);
+void finish_frame(struct data_bus *data_bus);
+uint64_t render_horizon(struct data_bus *data_bus, uint64_t limit);
+
+void color_math(uint16_t *out, const uint16_t *main, const uint16_t *sub, const uint16_t *flags, int subtract, int count);
 
 void latch_HVCT(struct data_bus *data_bus);
 void clear_HVCT(struct data_bus *data_bus);
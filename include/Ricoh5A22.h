@@ -4,6 +4,11 @@
 #include <stdint.h>
 #include "memory.h"
 
+// 1 -> dispatch through the size-specialized opcode tables, 0 -> execute() switch
+#ifndef THREADED_CORE
+#define THREADED_CORE 1
+#endif
+
 #define BUS_B_ACCESS_SPEED 3.58
 #define INTERNAL_ACCESS_SPEED 3.58
 #define BUS_A_ACCESS_SPEED 3.58
@@ -421,6 +426,45 @@
 
 #define OPCODE_XCE_IMP 0xFB
 
+typedef void (*opcode_handler)(struct data_bus*);
+
+// DECODE CACHE
+
+#define DECODE_CACHE_SIZE 0x2000
+#define DECODE_CACHE_INDEX(addr) (((addr) ^ ((addr) >> 16)) & (DECODE_CACHE_SIZE - 1))
+#define DECODE_BYTES 4 // opcode + longest operand
+#define UNDECODED_KEY 0xFFFFFFFF
+
+struct decoded_instruction
+{
+	uint32_t key; // 24-bit PC | size_flags << 24
+	uint32_t addr;
+	uint8_t length; // bytes served from the cache, cut short at the end of the page
+	uint8_t bytes[DECODE_BYTES];
+	uint8_t cycles[DECODE_BYTES];
+
+	uint32_t *generation; // page generation the bytes were read at
+	uint32_t generation_value;
+
+	opcode_handler handler;
+};
+
+// registers at the head of a loop that might only be polling, see skip_idle_loop()
+struct loop_state
+{
+	uint16_t register_X;
+	uint16_t register_Y;
+	uint16_t register_A;
+	uint16_t stack_ptr;
+	uint16_t direct_page;
+	uint16_t program_ctr;
+
+	uint8_t data_bank;
+	uint8_t program_bank;
+	uint8_t cpu_emulation6502;
+	uint8_t cpu_status;
+};
+
 struct Ricoh_5A22
 {
 	uint16_t register_X;
@@ -440,8 +484,20 @@ struct Ricoh_5A22
 	uint8_t cpu_emulation6502;
 	uint8_t cpu_status;
 
+	// M/X specialized handlers for the current cpu_status
+	const opcode_handler *opcode_table;
+	uint8_t size_flags; // (M is 16-bit) << 1 | (X is 16-bit)
+
+	struct decoded_instruction *decode_cache;
+	struct decoded_instruction *decoded; // instruction currently being executed
+
 	int queued_cyles;
 
+	struct loop_state loop_head;
+	uint64_t loop_clock; // master cycle the loop head was passed on
+	uint64_t loop_deadline; // event_clock at the time
+	int loop_clean; // nothing written, only WRAM, ROM and unchanging status registers read since
+
 	int LPM;
 	int RDY;
 
@@ -507,13 +563,19 @@ struct Ricoh_5A22
 };
 
 void print_cpu(struct Ricoh_5A22 *cpu);
+void swap_cpu_status(struct Ricoh_5A22 *cpu, uint8_t new_flags);
+void init_ricoh_5a22(struct data_bus *data_bus);
 void reset_ricoh_5a22(struct data_bus *data_bus);
 uint8_t fetch(struct data_bus *data_bus);
 void execute(struct data_bus *data_bus, uint8_t instruction);
+void dispatch(struct data_bus *data_bus, uint8_t instruction);
 
 void hw_nmi(struct data_bus *data_bus);
 void hw_reset(struct data_bus *data_bus);
 void hw_irq(struct data_bus *data_bus);
 
+struct decoded_instruction *decode_instruction(struct data_bus *data_bus, uint32_t addr);
+void flush_decode_cache(struct Ricoh_5A22 *cpu);
+
 #endif // RICOH_5A22_H
 
@@ -2,7 +2,41 @@
 #define CARTRIDGE_H
 
 #include "memory.h"
+#include <stddef.h>
+#include <stdint.h>
 
-void load_ROM(const char *filename, struct data_bus *data_bus);
+#define COPIER_HEADER_BYTES 512
+
+// where each layout keeps its internal header, as ROM image offsets
+#define LoROM_HEADER 0x007FC0
+#define HiROM_HEADER 0x00FFC0
+#define ExHiROM_HEADER 0x40FFC0
+
+#define HEADER_TITLE 0x00
+#define HEADER_TITLE_BYTES 21
+#define HEADER_MAP_MODE 0x15
+#define HEADER_CARTRIDGE_TYPE 0x16
+#define HEADER_ROM_SIZE 0x17
+#define HEADER_SRAM_SIZE 0x18
+#define HEADER_REGION 0x19
+#define HEADER_COMPLEMENT 0x1C
+#define HEADER_CHECKSUM 0x1E
+#define HEADER_RESET_VECTOR 0x3C
+#define HEADER_BYTES 0x40
+
+struct Cartridge
+{
+	uint8_t *mapping; // the whole file, read-only and shared with every other process mapping it
+	size_t mapping_size;
+	int mapped; // 0 when the image had to be copied instead
+
+	uint8_t *ROM; // the image without its copier header, at least ROM_size bytes rounded up to PAGE_SIZE
+	uint32_t ROM_size;
+
+	uint8_t ROM_type_marker;
+};
+
+int load_ROM(const char *filename, struct Cartridge *cartridge);
+void unload_ROM(struct Cartridge *cartridge);
 
 #endif // CARTRIDGE_H
@@ -23,6 +23,8 @@
 #define REG_SIZE \
 	MEMORY_AREA(REG_BANKS[0], REG_BYTES[0], \
 				REG_BANKS[1], REG_BYTES[1])
+#define REG_BANK_BYTES 0x4000 // $2000-$5FFF
+#define REG_INDEX(addr) (((addr) & 0x0000FFFF) - 0x2000) // every bank's registers fold onto the first
 
 // LoROM ADDRESSES
 
@@ -75,7 +77,7 @@
 
 #define HiROM_MARKER 0x21
 
-#define HiROM_SRAM_BANKS (uint8_t[]){ 0x30, 0x3F }
+#define HiROM_SRAM_BANKS (uint8_t[]){ 0xB0, 0xBF } // $30-$3F is folded onto $B0-$BF
 #define HiROM_SRAM_BYTES (uint16_t[]){ 0x6000, 0x7FFF }
 #define HiROM_SRAM_SIZE MEMORY_AREA(HiROM_SRAM_BANKS[0], HiROM_SRAM_BYTES[0], HiROM_SRAM_BANKS[1], HiROM_SRAM_BYTES[1])
 
@@ -115,6 +117,86 @@
 #define ExHiROM_ExROM_SUBSIZE_2 MEMORY_AREA(ExHiROM_ExROM_BANKS[2], ExHiROM_ExROM_BYTES[2], ExHiROM_ExROM_BANKS[3], ExHiROM_ExROM_BYTES[3])
 #define ExHiROM_ExROM_SIZE ExHiROM_ExROM_SUBSIZE_1 + ExHiROM_ExROM_SUBSIZE_2
 
+#define IN_HiROM_ROM(i) \
+	WITHIN_REGION(i, HiROM_ROM_BANKS[0], HiROM_ROM_BYTES[0], \
+					 HiROM_ROM_BANKS[1], HiROM_ROM_BYTES[1])
+
+#define IN_HiROM_ROM_MIRROR(i) \
+	WITHIN_REGION(i, HiROM_MIRROR_2_BANKS[0], HiROM_MIRROR_BYTES[0], \
+					 HiROM_MIRROR_2_BANKS[1], HiROM_MIRROR_BYTES[1])
+
+#define IN_HiROM_SRAM(i) \
+	WITHIN_REGION(i, HiROM_SRAM_BANKS[0], HiROM_SRAM_BYTES[0], \
+					 HiROM_SRAM_BANKS[1], HiROM_SRAM_BYTES[1])
+
+// ExHiROM tells $00-$7D and $80-$FF apart, these take the address before it's folded
+#define IN_ExHiROM_ROM(i) \
+	WITHIN_REGION(i, ExHiROM_ROM_BANKS[0], ExHiROM_ROM_BYTES[0], \
+					 ExHiROM_ROM_BANKS[1], ExHiROM_ROM_BYTES[1])
+
+#define IN_ExHiROM_ROM_MIRROR(i) \
+	WITHIN_REGION(i, ExHiROM_ROM_MIRROR_BANKS[0], ExHiROM_ROM_MIRROR_BYTES[0], \
+					 ExHiROM_ROM_MIRROR_BANKS[1], ExHiROM_ROM_MIRROR_BYTES[1])
+
+#define IN_ExHiROM_ExROM(i) \
+	(WITHIN_REGION(i, ExHiROM_ExROM_BANKS[0], ExHiROM_ExROM_BYTES[0], \
+					  ExHiROM_ExROM_BANKS[1], ExHiROM_ExROM_BYTES[1]) || \
+	WITHIN_REGION(i, ExHiROM_ExROM_BANKS[2], ExHiROM_ExROM_BYTES[2], \
+					 ExHiROM_ExROM_BANKS[3], ExHiROM_ExROM_BYTES[3]))
+
+#define IN_ExHiROM_ExROM_MIRROR(i) \
+	WITHIN_REGION(i, ExHiROM_ExROM_MIRROR_BANKS[0], ExHiROM_ExROM_MIRROR_BYTES[0], \
+					 ExHiROM_ExROM_MIRROR_BANKS[1], ExHiROM_ExROM_MIRROR_BYTES[1])
+
+#define IN_ExHiROM_SRAM(i) \
+	WITHIN_REGION(i, ExHiROM_SRAM_BANKS[0], ExHiROM_SRAM_BYTES[0], \
+					 ExHiROM_SRAM_BANKS[1], ExHiROM_SRAM_BYTES[1])
+
+// PAGE TABLE
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define PAGE_MASK (PAGE_SIZE - 1)
+#define N_PAGES (0x01000000 >> PAGE_SHIFT)
+#define PAGE_INDEX(addr) (((addr) & 0x00FFFFFF) >> PAGE_SHIFT)
+
+#define FAST_ACCESS 6
+#define MEDIUM_ACCESS 8
+#define SLOW_ACCESS 12
+#define MIXED_ACCESS 0 // $4000-$41FF is slow but shares its page with fast registers
+
+enum page_type
+{
+	PAGE_OPEN_BUS,
+	PAGE_RAM,
+	PAGE_ROM,
+	PAGE_REG
+};
+
+struct page
+{
+	uint8_t *ptr; // host address of the first byte in the page, NULL when a handler owns it
+	enum page_type type;
+	uint8_t access_cycles;
+	uint32_t *generation; // bumped on every write, NULL when code here can't be cached
+};
+
+// REGISTER DISPATCH
+
+#define B_BUS_REGISTERS 0x0100 // $2100-$21FF
+#define A_BUS_REGISTERS 0x0400 // $4000-$43FF
+
+struct data_bus;
+
+typedef uint8_t (*register_read)(struct data_bus *data_bus, uint32_t addr);
+typedef void (*register_write)(struct data_bus *data_bus, uint32_t addr, uint8_t write_value);
+
+struct register_handler
+{
+	register_read read;
+	register_write write;
+};
+
 struct LoROM
 {
 	uint8_t *SRAM;
@@ -144,6 +226,8 @@ union ROM_t
 struct Memory
 {
 	uint8_t *WRAM;
+	uint32_t *WRAM_generation; // one per 4 KiB of WRAM, invalidates decoded instructions
+	uint32_t ROM_generation; // never changes
 	uint32_t WRAM_addr; // https://snes.nesdev.org/wiki/WRAM_pinout
 						// PS1, /PS5..1: Peripheral select, connected to PA7..2 to map S-WRAM to peripheral bus addresses $80-83.
 						// PA1..0: These select the S-WRAM register being accessed on the peripheral bus (WRAM data or address).
@@ -152,11 +236,18 @@ struct Memory
 
 	uint8_t ROM_type_marker;
 	union ROM_t ROM;
+	uint32_t ROM_size; // bytes in the cartridge image, ROM pages past it mirror back into it
+
+	struct page *page_table; // one entry per 4 KiB of the 24-bit A-bus, built once the ROM buffers exist
+
+	struct register_handler *B_bus_registers;
+	struct register_handler *A_bus_registers;
 };
 
 struct Ricoh_5A22;
 struct PPU;
 struct DMA;
+struct Scheduler;
 
 struct data_bus
 {
@@ -172,24 +263,32 @@ struct data_bus
 		struct Memory *memory;
 	} A_Bus;
 
+	struct Scheduler *scheduler;
+
 	uint8_t open_value;
 };
 
 uint32_t convert_to_cartridge_addr(uint32_t addr);
 
-void init_memory(struct Memory *memory, uint8_t ROM_type_marker);
+void init_memory(struct Memory *memory, uint8_t ROM_type_marker, uint8_t *ROM, uint32_t ROM_size);
+void map_memory(struct Memory *memory);
+void map_access_cycles(struct Memory *memory, int fast_ROM);
 
+uint8_t bus_cycles(struct data_bus *data_bus, uint32_t addr);
 uint8_t DB_read(struct data_bus *data_bus, uint32_t addr);
 uint8_t mem_read(struct data_bus *data_bus, uint32_t addr);
+uint8_t read_page(struct data_bus *data_bus, struct page *page, uint32_t addr);
 
-void ROM_write(struct data_bus *data_bus, uint32_t addr, uint8_t val);
 void write_register_raw(struct data_bus *data_bus, uint32_t addr, uint8_t val);
 uint8_t read_register_raw(struct data_bus *data_bus, uint32_t addr);
 void DB_write(struct data_bus *data_bus, uint32_t addr, uint8_t write_val);
 void mem_write(struct data_bus *data_bus, uint32_t addr, uint8_t write_val);
+void write_page(struct data_bus *data_bus, struct page *page, uint32_t addr, uint8_t write_val);
 
-void read_ppu_register(struct data_bus *data_bus, uint32_t addr);
-void write_ppu_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value);
+void map_register(struct Memory *memory, uint16_t addr, register_read read, register_write write);
+struct register_handler *get_register(struct Memory *memory, uint32_t addr);
+
+void map_ppu_registers(struct Memory *memory);
 uint16_t read_VRAM(struct data_bus *data_bus, uint16_t addr);
 void write_VRAM_word(struct data_bus *data_bus, uint16_t addr, uint16_t word);
 void write_VRAM_low(struct data_bus *data_bus, uint16_t addr, uint8_t byte);
@@ -198,25 +297,22 @@ uint8_t read_OAM(struct data_bus *data_bus, uint16_t addr);
 void write_OAM(struct data_bus *data_bus, uint16_t addr, uint8_t byte);
 void write_CGRAM_word(struct data_bus *data_bus, uint16_t addr, uint16_t word);
 uint16_t read_CGRAM(struct data_bus *data_bus, uint16_t addr);
+void write_VMDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count, int port, int alternate);
+void write_CGDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count);
+void write_OAMDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count);
 
-void read_wram_register(struct data_bus *data_bus, uint32_t addr);
-void write_wram_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value);
-
-void read_cpu_register(struct data_bus *data_bus, uint32_t addr);
-void write_cpu_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value);
-
-void read_dma_register(struct data_bus *data_bus, uint32_t addr);
-void write_dma_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value);
+void map_wram_registers(struct Memory *memory);
+void write_WMDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count);
+void map_cpu_registers(struct Memory *memory);
+void map_dma_registers(struct Memory *memory);
 
 void signal_vblank(struct data_bus *data_bus);
 void clear_vblank(struct data_bus *data_bus);
 void signal_hblank(struct data_bus *data_bus);
 void clear_hblank(struct data_bus *data_bus);
-void check_IRQ(struct data_bus *data_bus);
+void signal_IRQ(struct data_bus *data_bus);
 void set_refresh(struct data_bus *data_bus);
 
-void allow_HDMA(struct data_bus *data_bus);
-void disallow_HDMA(struct data_bus *data_bus);
 void sync_DMA(struct data_bus *data_bus, int cycles);
 
 #endif
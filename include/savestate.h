@@ -0,0 +1,35 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include "memory.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SAVE_STATE_MAGIC 0x535A4E53 // "SNZS"
+#define SAVE_STATE_VERSION 2
+
+// the sections are raw struct images, a state only loads into a build with the same layout
+struct save_state_header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size; // whole state, header included
+
+	uint8_t ROM_type_marker;
+	uint32_t ROM_size;
+	uint64_t ROM_hash;
+
+	uint32_t cpu_bytes;
+	uint32_t ppu_bytes;
+	uint32_t dma_bytes;
+	uint32_t scheduler_bytes;
+};
+
+size_t save_state_size(struct data_bus *data_bus);
+size_t save_state(struct data_bus *data_bus, uint8_t *buffer, size_t size);
+int load_state(struct data_bus *data_bus, const uint8_t *buffer, size_t size);
+
+int save_state_file(struct data_bus *data_bus, const char *filename);
+int load_state_file(struct data_bus *data_bus, const char *filename);
+
+#endif // SAVESTATE_H
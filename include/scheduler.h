@@ -0,0 +1,28 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "memory.h"
+#include <stdint.h>
+
+#define REFRESH_CYCLES 40
+#define NO_DEADLINE UINT64_MAX
+
+struct Scheduler
+{
+	uint64_t master_clock; // master cycle the current step started on
+	uint64_t ppu_clock; // master cycle the next PPU dot is due on
+	uint64_t line_clock; // master cycle the beam's line started on
+	uint64_t IRQ_clock; // master cycle the H/V timer fires on next
+	uint64_t event_clock; // earliest master cycle the PPU or the timer has anything to do
+};
+
+void init_scheduler(struct data_bus *data_bus);
+
+uint64_t current_master_cycle(struct data_bus *data_bus);
+void sync_PPU(struct data_bus *data_bus, uint64_t target);
+void schedule_IRQ(struct data_bus *data_bus);
+
+void run_step(struct data_bus *data_bus);
+void run_frame(struct data_bus *data_bus);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// built in with -DTRACE=1, otherwise every TRACE_EVENT compiles to nothing
+#ifndef TRACE
+#define TRACE 0
+#endif
+
+#define TRACE_RING_RECORDS 0x10000 // power of 2
+
+enum trace_category
+{
+	TRACE_VRAM = 0x01,
+	TRACE_DMA = 0x02,
+	TRACE_FRAME = 0x04,
+	TRACE_MEMORY = 0x08,
+	TRACE_ALL = 0x0F
+};
+
+enum trace_event_type
+{
+	TRACE_VRAM_ADDR,
+	TRACE_VRAM_WRITE,
+	TRACE_DMA_START,
+	TRACE_FRAME_DRAWN,
+	TRACE_ROM_WRITE
+};
+
+// formatted later by the writer thread, never on the emulation thread
+struct trace_record
+{
+	uint32_t a;
+	uint32_t b;
+	uint8_t type;
+};
+
+extern uint32_t trace_mask;
+
+void trace_push(uint8_t type, uint32_t a, uint32_t b);
+
+uint32_t parse_trace_categories(const char *categories);
+int start_trace(uint32_t mask, const char *filename);
+void stop_trace(void);
+
+#if TRACE
+#define TRACE_EVENT(category, type, a, b) \
+	do \
+	{ \
+		if(__builtin_expect(trace_mask & (category), 0)) \
+		{ \
+			trace_push(type, a, b); \
+		} \
+	} while(0)
+#else
+#define TRACE_EVENT(category, type, a, b) \
+	do \
+	{ \
+		(void)(a); \
+		(void)(b); \
+	} while(0)
+#endif
+
+#endif // TRACE_H
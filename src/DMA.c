@@ -4,22 +4,56 @@
 #include <string.h>
 
 #include "DMA.h"
+#include "PPU.h"
+#include "ricoh5A22.h"
 #include "registers.h"
 #include "memory.h"
+#include "scheduler.h"
 #include "utility.h"
+#include "trace.h"
+
+enum Bulk_port
+{
+	BULK_NONE,
+	BULK_VMDATAL,
+	BULK_VMDATAH,
+	BULK_VMDATA,
+	BULK_CGDATA,
+	BULK_OAMDATA,
+	BULK_WMDATA
+};
+
+static const int pattern_bytes[8] = { 1, 2, 2, 4, 4, 4, 2, 4 };
+static const int pattern_offsets[8][4] = 
+{
+	{ 0 },
+	{ 0, 1 },
+	{ 0, 0 },
+	{ 0, 0, 1, 1 },
+	{ 0, 1, 2, 3 },
+	{ 0, 1, 0, 1 },
+	{ 0, 0 },
+	{ 0, 0, 1, 1 }
+};
 
 void init_DMA(struct data_bus *data_bus)
 {
 	data_bus->B_bus.dma->queued_cycles = 0;
 	data_bus->B_bus.dma->elapsed_cycles = 0;
-	data_bus->B_bus.dma->HDMA_allowed = 0;
 	data_bus->B_bus.dma->dma_active = 0;
 
 	data_bus->B_bus.dma->MDMA_channel_over = 1;
 	data_bus->B_bus.dma->new_MDMA_transfer = 0;
 
-	memset(data_bus->B_bus.dma->HDMA_channels_finished, 1, N_CHANNELS);
-	memset(data_bus->B_bus.dma->HDMA_need_indirect, 1, N_CHANNELS);
+	for(int i = 0; i < N_CHANNELS; i++)
+	{
+		data_bus->B_bus.dma->HDMA_program[i] = malloc((HDMA_LINES + 1) * sizeof(struct HDMA_line));
+		data_bus->B_bus.dma->HDMA_program_start[i] = 0;
+		data_bus->B_bus.dma->HDMA_program_end[i] = 0;
+		data_bus->B_bus.dma->HDMA_page_count[i] = 0;
+		data_bus->B_bus.dma->HDMA_do_transfer[i] = 0;
+		data_bus->B_bus.dma->HDMA_terminated[i] = 1;
+	}
 
 	mem_write(data_bus, MDMAEN, 0x00);
 	mem_write(data_bus, HDMAEN, 0x00);
@@ -49,163 +83,308 @@ void init_DMA(struct data_bus *data_bus)
 	data_bus->B_bus.dma->alignment_counter = 0;
 }
 
-uint32_t get_HDMA_table_index(struct DMA *dma, int channel)
+static void load_HDMA_state(struct DMA *dma, int channel, struct HDMA_state *state)
 {
-	uint32_t addr = dma->DMA_source_addr[channel] & 0x00FF0000;
-	addr |= dma->HDMA_A_table_index[channel];
+	state->table_addr = (dma->DMA_source_addr[channel] & 0x00FF0000) | dma->HDMA_A_table_index[channel];
+	state->indirect_addr = dma->DMA_size_or_indirect[channel] & 0x00FFFFFF;
+	state->param_byte = dma->param_byte[channel];
+	state->B_addr = dma->DMA_B_addr[channel];
+	state->line_counter = (dma->HDMA_repeat[channel] << 7) | (dma->HDMA_scanline_counter[channel] & 0b01111111);
+	state->do_transfer = dma->HDMA_do_transfer[channel];
+	state->terminated = dma->HDMA_terminated[channel];
+}
+
+static void store_HDMA_state(struct DMA *dma, int channel, struct HDMA_state *state)
+{
+	dma->HDMA_A_table_index[channel] = state->table_addr & 0x0000FFFF;
+	dma->DMA_size_or_indirect[channel] = (dma->DMA_size_or_indirect[channel] & 0xFFFF0000) | (state->indirect_addr & 0x0000FFFF);
+	dma->HDMA_repeat[channel] = check_bit8(state->line_counter, 0x80);
+	dma->HDMA_scanline_counter[channel] = state->line_counter & 0b01111111;
+	dma->HDMA_do_transfer[channel] = state->do_transfer;
+	dma->HDMA_terminated[channel] = state->terminated;
+}
 
-	return addr;
+static int same_HDMA_state(struct HDMA_state *a, struct HDMA_state *b)
+{
+	return a->table_addr == b->table_addr && a->indirect_addr == b->indirect_addr &&
+		a->param_byte == b->param_byte && a->B_addr == b->B_addr &&
+		a->line_counter == b->line_counter && a->do_transfer == b->do_transfer &&
+		a->terminated == b->terminated;
 }
 
-void HDMA_transfer_byte(struct data_bus *data_bus, int channel, uint32_t *A_addr, uint32_t B_addr)
-{	
+// reads a table or data byte, when compiling only from pages whose writes are counted
+static int HDMA_read(struct data_bus *data_bus, int channel, int live, uint32_t addr, uint8_t *value)
+{
 	struct DMA *dma = data_bus->B_bus.dma;
+	struct page *page = &data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)];
 
-	if(dma->direction[channel] == A_to_B)
+	if(live)
 	{
-		mem_write(data_bus, B_addr, mem_read(data_bus, *A_addr));
+		*value = mem_read(data_bus, addr);
+
+		return 1;
 	}
-	else 
+
+	if(!page->ptr || !page->generation)
 	{
-		mem_write(data_bus, *A_addr, mem_read(data_bus, B_addr));
+		return 0;
 	}
 
-	(*A_addr)++;
+	int n = 0;
 
-	dma->queued_cycles += 8;
+	while(n < dma->HDMA_page_count[channel] && dma->HDMA_pages[channel][n] != page->generation)
+	{
+		n++;
+	}
+
+	if(n == dma->HDMA_page_count[channel])
+	{
+		if(n == HDMA_PAGES)
+		{
+			return 0;
+		}
+
+		dma->HDMA_pages[channel][n] = page->generation;
+		dma->HDMA_page_generation[channel][n] = *page->generation;
+		dma->HDMA_page_count[channel]++;
+	}
+
+	*value = page->ptr[addr & PAGE_MASK];
+
+	return 1;
 }
 
-void HDMA_use_pattern(struct data_bus *data_bus, int channel)
+static int HDMA_next_entry(struct data_bus *data_bus, int channel, int live, struct HDMA_state *state, struct HDMA_line *line)
 {
-	struct DMA *dma = data_bus->B_bus.dma;
+	uint8_t low = 0;
+	uint8_t high = 0;
+	uint32_t bank = state->table_addr & 0x00FF0000;
 
-	uint32_t A_addr = 0;
-	uint32_t B_addr = 0x00002100 | dma->DMA_B_addr[channel];
+	if(!HDMA_read(data_bus, channel, live, state->table_addr, &state->line_counter))
+	{
+		return 0;
+	}
 
-	if(dma->HDMA_indirect[channel])
+	state->table_addr = bank | ((state->table_addr + 1) & 0x0000FFFF);
+
+	if(check_bit8(state->param_byte, 0x40))
 	{
-		A_addr = dma->DMA_size_or_indirect[channel];
+		if(!HDMA_read(data_bus, channel, live, state->table_addr, &low))
+		{
+			return 0;
+		}
+
+		if(!HDMA_read(data_bus, channel, live, bank | ((state->table_addr + 1) & 0x0000FFFF), &high))
+		{
+			return 0;
+		}
+
+		state->table_addr = bank | ((state->table_addr + 2) & 0x0000FFFF);
+		state->indirect_addr = (state->indirect_addr & 0x00FF0000) | LE_COMBINE_2BYTE(low, high);
+
+		line->cycles += 16;
 	}
-	else 
+
+	state->terminated = state->line_counter == 0;
+	state->do_transfer = 1;
+
+	line->cycles += 8;
+
+	return 1;
+}
+
+// works out one line of a channel from state, returns 0 if it can't be compiled
+// a live line also does its own B-bus to A-bus transfer, A-bus to B-bus bytes are left in line
+static int HDMA_walk_line(struct data_bus *data_bus, int channel, int live, struct HDMA_state *state, struct HDMA_line *line)
+{
+	int indirect = check_bit8(state->param_byte, 0x40);
+	int pattern = state->param_byte & 0b00000111;
+	uint32_t *addr = indirect ? &state->indirect_addr : &state->table_addr;
+
+	line->count = 0;
+	line->cycles = 8;
+
+	if(state->do_transfer)
 	{
-		A_addr = get_HDMA_table_index(dma, channel);
+		for(int i = 0; i < pattern_bytes[pattern]; i++)
+		{
+			uint32_t bank = *addr & 0x00FF0000;
+
+			if(check_bit8(state->param_byte, 0x80))
+			{
+				if(!live)
+				{
+					return 0;
+				}
+
+				uint32_t B_addr = (B_BUS_ADDR | state->B_addr) + pattern_offsets[pattern][i];
+
+				mem_write(data_bus, *addr, mem_read(data_bus, B_addr));
+			}
+			else if(!HDMA_read(data_bus, channel, live, *addr, &line->bytes[i]))
+			{
+				return 0;
+			}
+
+			*addr = bank | ((*addr + 1) & 0x0000FFFF);
+		}
+
+		line->count = pattern_bytes[pattern];
 	}
 
-	switch(dma->transfer_pattern[channel])
+	state->line_counter--;
+	state->do_transfer = check_bit8(state->line_counter, 0x80);
+
+	if((state->line_counter & 0b01111111) == 0)
 	{
-		case P0:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
+		return HDMA_next_entry(data_bus, channel, live, state, line);
+	}
 
-			break;
-		case P1:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
+	return 1;
+}
 
-			break;
-		case P2:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
+static void compile_HDMA(struct data_bus *data_bus, int channel, int first_line)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
+	struct HDMA_line *program = dma->HDMA_program[channel];
+	struct HDMA_state state;
 
-			break;
-		case P3:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
+	load_HDMA_state(dma, channel, &state);
 
-			break;
-		case P4:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 2);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 3);
+	dma->HDMA_page_count[channel] = 0;
+	dma->HDMA_program_start[channel] = first_line;
 
-			break;
-		case P5:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
+	int line = first_line;
 
-			break;
-		case P6:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
+	program[line].state = state;
 
-			break;
-		case P7:
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
-			HDMA_transfer_byte(data_bus, channel, &A_addr, B_addr + 1);
+	while(line < HDMA_LINES && !state.terminated && HDMA_walk_line(data_bus, channel, 0, &state, &program[line]))
+	{
+		line++;
+		program[line].state = state;
+	}
 
-			break;
+	dma->HDMA_program_end[channel] = line;
+}
+
+static int HDMA_program_valid(struct DMA *dma, int channel, int line, struct HDMA_state *state)
+{
+	if(line < dma->HDMA_program_start[channel] || line >= dma->HDMA_program_end[channel])
+	{
+		return 0;
+	}
+
+	// the CPU rewrote the channel's registers
+	if(!same_HDMA_state(&dma->HDMA_program[channel][line].state, state))
+	{
+		return 0;
 	}
 
-	if(dma->HDMA_indirect[channel])
+	// or the memory the program was read from
+	for(int n = 0; n < dma->HDMA_page_count[channel]; n++)
 	{
-		dma->DMA_size_or_indirect[channel] = A_addr;
+		if(*dma->HDMA_pages[channel][n] != dma->HDMA_page_generation[channel][n])
+		{
+			return 0;
+		}
 	}
-	else 
+
+	return 1;
+}
+
+static void HDMA_write_line(struct data_bus *data_bus, struct HDMA_state *state, struct HDMA_line *line)
+{
+	int pattern = state->param_byte & 0b00000111;
+
+	for(int i = 0; i < line->count && !check_bit8(state->param_byte, 0x80); i++)
 	{
-		dma->HDMA_A_table_index[channel] = A_addr;
+		mem_write(data_bus, (B_BUS_ADDR | state->B_addr) + pattern_offsets[pattern][i], line->bytes[i]);
 	}
 }
 
-void HDMA_transfer_bytes(struct data_bus *data_bus, int channel)
+// V = 0, every enabled channel starts over from the top of its table
+void init_HDMA_frame(struct data_bus *data_bus)
 {
 	struct DMA *dma = data_bus->B_bus.dma;
+	int cycles = 0;
 
-	if(dma->HDMA_scanline_counter[channel] == 0) // always clears to 0 when it needs a new one
+	for(int channel = 0; channel < N_CHANNELS; channel++)
 	{
-		uint8_t limiter = mem_read(data_bus, get_HDMA_table_index(dma, channel));
-		dma->HDMA_A_table_index[channel]++;
+		struct HDMA_state state;
+		struct HDMA_line line = { 0 };
 
-		if(limiter == 0x00)
+		if(!dma->HDMA_enable[channel])
 		{
-			dma->HDMA_enable[channel] = 0;
-
-			return;
+			continue;
 		}
-		else 
-		{
-			dma->HDMA_scanline_counter[channel] = limiter & 0b01111111;
-			dma->HDMA_repeat[channel] = (limiter & 0b10000000) >> 7;
 
-			if(dma->HDMA_indirect[channel])
-			{
-				uint16_t indirect_addr = 0x0000;
-				indirect_addr |= mem_read(data_bus, get_HDMA_table_index(dma, channel));
-				dma->HDMA_A_table_index[channel]++;
-				indirect_addr |= mem_read(data_bus, get_HDMA_table_index(dma, channel));
-				dma->HDMA_A_table_index[channel]++;
+		load_HDMA_state(dma, channel, &state);
 
-				dma->DMA_size_or_indirect[channel] |= indirect_addr;
+		state.table_addr = dma->DMA_source_addr[channel] & 0x00FFFFFF;
 
-				dma->queued_cycles += 16;
-			}
+		HDMA_next_entry(data_bus, channel, 1, &state, &line);
+		store_HDMA_state(dma, channel, &state);
 
-			HDMA_use_pattern(data_bus, channel);
-		}
+		dma->MDMA_enable[channel] = 0;
+		cycles += line.cycles;
 	}
-	else 
+
+	if(cycles)
 	{
-		if(dma->HDMA_repeat[channel])
-		{
-			HDMA_use_pattern(data_bus, channel);
-		}
+		data_bus->A_Bus.cpu->queued_cyles += HDMA_SETUP_CYCLES + cycles;
 	}
-
-	dma->queued_cycles += 8;
 }
 
-void HDMA_step(struct data_bus *data_bus, int channel)
+// the H-blank transfers of one line, replayed from the channel's program while it's still valid
+void run_HDMA_line(struct data_bus *data_bus, int line)
 {
 	struct DMA *dma = data_bus->B_bus.dma;
+	int cycles = 0;
+
+	for(int channel = 0; channel < N_CHANNELS; channel++)
+	{
+		struct HDMA_state state;
+
+		if(!dma->HDMA_enable[channel] || dma->HDMA_terminated[channel])
+		{
+			continue;
+		}
+
+		load_HDMA_state(dma, channel, &state);
+
+		if(!HDMA_program_valid(dma, channel, line, &state))
+		{
+			compile_HDMA(data_bus, channel, line);
+		}
+
+		if(line < dma->HDMA_program_end[channel])
+		{
+			struct HDMA_line *program = &dma->HDMA_program[channel][line];
+
+			HDMA_write_line(data_bus, &state, program);
+			store_HDMA_state(dma, channel, &program[1].state);
+
+			cycles += program->cycles + program->count * 8;
+		}
+		else 
+		{
+			// a page the program can't watch, walk this line through the bus
+			struct HDMA_line live_line;
+
+			HDMA_walk_line(data_bus, channel, 1, &state, &live_line);
+			HDMA_write_line(data_bus, &state, &live_line);
+			store_HDMA_state(dma, channel, &state);
+
+			cycles += live_line.cycles + live_line.count * 8;
+		}
 
-	HDMA_transfer_bytes(data_bus, channel);
+		dma->MDMA_enable[channel] = 0;
+	}
 
-	dma->HDMA_channels_finished[channel] = 1;
+	if(cycles)
+	{
+		data_bus->A_Bus.cpu->queued_cyles += HDMA_SETUP_CYCLES + cycles;
+	}
 }
 
 void transfer_byte(struct data_bus *data_bus, int channel, int b_offset)
@@ -258,19 +437,10 @@ void transfer_byte(struct data_bus *data_bus, int channel, int b_offset)
 	dma->queued_cycles += 8;
 }
 
-void MDMA_step(struct data_bus *data_bus, int channel)
+void transfer_unit(struct data_bus *data_bus, int channel)
 {
 	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(dma->MDMA_channel_over)
-	{
-		printf("NEW DMA, %06x\n", dma->DMA_source_addr[channel]);
-		dma->queued_cycles += 8;
-	}
-
-	dma->MDMA_channel_over = 0;
-
-
 	switch(dma->transfer_pattern[channel])
 	{
 		case P0:
@@ -321,27 +491,313 @@ void MDMA_step(struct data_bus *data_bus, int channel)
 
 			break;
 	}
+}
 
-	if((dma->DMA_size_or_indirect[channel] & 0x0000FFFF) <= 0)
+// the B-bus port a channel streams every byte into, if the bulk path knows it
+static enum Bulk_port bulk_port(struct DMA *dma, int channel)
+{
+	if(dma->direction[channel] != A_to_B)
 	{
-		dma->MDMA_enable[channel] = 0;
-		dma->MDMA_channel_over = 1;
+		return BULK_NONE;
 	}
+
+	switch(dma->transfer_pattern[channel])
+	{
+		case P0:
+		case P2:
+		case P6:
+			switch(dma->DMA_B_addr[channel])
+			{
+				case OAMDATA & 0xFF:
+					return BULK_OAMDATA;
+				case VMDATAL & 0xFF:
+					return BULK_VMDATAL;
+				case VMDATAH & 0xFF:
+					return BULK_VMDATAH;
+				case CGDATA & 0xFF:
+					return BULK_CGDATA;
+				case WMDATA & 0xFF:
+					return BULK_WMDATA;
+				default:
+					break;
+			}
+
+			break;
+		case P1:
+		case P5:
+			if(dma->DMA_B_addr[channel] == (VMDATAL & 0xFF))
+			{
+				return BULK_VMDATA;
+			}
+
+			break;
+		default:
+			break;
+	}
+
+	return BULK_NONE;
 }
 
-int check_new_HDMA(struct DMA *dma)
+// first master cycle an HDMA transfer or frame setup could run at, capped at limit
+static uint64_t HDMA_horizon(struct data_bus *data_bus, uint64_t limit)
 {
-	int check = 1;
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	struct DMA *dma = data_bus->B_bus.dma;
+	uint64_t cycle = data_bus->scheduler->ppu_clock;
+	int x = ppu->x;
+	int y = ppu->y;
+	int enabled = 0;
+	int running = 0;
 
 	for(int i = 0; i < N_CHANNELS; i++)
 	{
-		if(dma->HDMA_channels_finished[i] != 0)
+		enabled |= dma->HDMA_enable[i];
+		running |= dma->HDMA_enable[i] && !dma->HDMA_terminated[i];
+	}
+
+	if(!enabled)
+	{
+		return limit;
+	}
+
+	while(cycle < limit)
+	{
+		if(x >= DOTS && y >= LINES)
+		{
+			break;
+		}
+
+		if(running && x == HIDE_DOTS + VISIBLE_DOTS && y < vblank_line(ppu) * 2)
+		{
+			break;
+		}
+
+		cycle += dot_cycles(x, y);
+		advance_beam(&x, &y);
+	}
+
+	return cycle < limit ? cycle : limit;
+}
+
+// bytes from addr on that can be read straight out of one page, 0 when a handler owns the page
+static int source_run(struct data_bus *data_bus, int channel, enum Bulk_port port, uint32_t addr, int count)
+{
+	struct Memory *memory = data_bus->A_Bus.memory;
+	struct DMA *dma = data_bus->B_bus.dma;
+	struct page *page = &memory->page_table[PAGE_INDEX(addr)];
+	int run = count;
+
+	if(!page->ptr)
+	{
+		return 0;
+	}
+
+	// WRAM to WMDATA reads what the previous byte wrote, leave it to transfer_byte
+	if(port == BULK_WMDATA && page->ptr >= memory->WRAM && page->ptr < memory->WRAM + WRAM_SIZE)
+	{
+		return 0;
+	}
+
+	switch(dma->MDMA_address_adjust[channel])
+	{
+		case Increment_A:
+			run = PAGE_SIZE - (addr & PAGE_MASK);
+
+			break;
+		case Fixed:
+			run = PAGE_SIZE;
+
+			break;
+		case Decrement_A:
+			run = (addr & PAGE_MASK) + 1;
+
+			break;
+	}
+
+	return run < count ? run : count;
+}
+
+static void bulk_write(struct data_bus *data_bus, enum Bulk_port port, const uint8_t *bytes, int count, int phase)
+{
+	switch(port)
+	{
+		case BULK_VMDATAL:
+			write_VMDATA_block(data_bus, bytes, count, 0, 0);
+
+			break;
+		case BULK_VMDATAH:
+			write_VMDATA_block(data_bus, bytes, count, 1, 0);
+
+			break;
+		case BULK_VMDATA:
+			write_VMDATA_block(data_bus, bytes, count, phase & 1, 1);
+
+			break;
+		case BULK_CGDATA:
+			write_CGDATA_block(data_bus, bytes, count);
+
+			break;
+		case BULK_OAMDATA:
+			write_OAMDATA_block(data_bus, bytes, count);
+
+			break;
+		case BULK_WMDATA:
+			write_WMDATA_block(data_bus, bytes, count);
+
+			break;
+		default:
+			break;
+	}
+}
+
+// moves as many whole units as the byte path would before anything could notice the difference
+static int MDMA_bulk(struct data_bus *data_bus, int channel)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
+
+	enum Bulk_port port = bulk_port(dma, channel);
+	int unit = pattern_bytes[dma->transfer_pattern[channel]];
+	uint32_t size = dma->DMA_size_or_indirect[channel] & 0x0000FFFF;
+
+	if(size == 0)
+	{
+		size = 0x10000;
+	}
+
+	int units = size / unit;
+
+	if(port == BULK_NONE || units < 2)
+	{
+		return 0;
+	}
+
+	// unit n is written once the PPU has caught up to start + n * 8 * unit
+	// an HDMA channel takes over the bus at the next H-blank it runs in
+	uint64_t start = current_master_cycle(data_bus) + dma->queued_cycles;
+	uint64_t horizon = HDMA_horizon(data_bus, start + (uint64_t)(units - 1) * 8 * unit);
+
+	if(port != BULK_WMDATA)
+	{
+		horizon = render_horizon(data_bus, horizon);
+	}
+
+	units = horizon < start ? 1 : (horizon - start) / (8 * unit) + 1;
+
+	int count = 0;
+	uint32_t addr = dma->DMA_source_addr[channel];
+
+	while(count < units * unit)
+	{
+		int run = source_run(data_bus, channel, port, addr, units * unit - count);
+
+		if(run == 0)
+		{
+			break;
+		}
+
+		if(dma->MDMA_address_adjust[channel] == Increment_A)
+		{
+			addr += run;
+		}
+		else if(dma->MDMA_address_adjust[channel] == Decrement_A)
 		{
-			check = 0;
+			addr -= run;
 		}
+
+		count += run;
+	}
+
+	count -= count % unit;
+
+	if(count < unit * 2)
+	{
+		return 0;
+	}
+
+	uint8_t buffer[PAGE_SIZE];
+	uint8_t last[2] = { 0, 0 };
+	int done = 0;
+
+	while(done < count)
+	{
+		uint32_t source = dma->DMA_source_addr[channel];
+		uint8_t *ptr = &data_bus->A_Bus.memory->page_table[PAGE_INDEX(source)].ptr[source & PAGE_MASK];
+		int run = source_run(data_bus, channel, port, source, count - done);
+		const uint8_t *bytes = ptr;
+
+		switch(dma->MDMA_address_adjust[channel])
+		{
+			case Increment_A:
+				dma->DMA_source_addr[channel] += run;
+
+				break;
+			case Fixed:
+				memset(buffer, *ptr, run);
+				bytes = buffer;
+
+				break;
+			case Decrement_A:
+				for(int i = 0; i < run; i++)
+				{
+					buffer[i] = *(ptr - i);
+				}
+
+				bytes = buffer;
+				dma->DMA_source_addr[channel] -= run;
+
+				break;
+		}
+
+		bulk_write(data_bus, port, bytes, run, done);
+
+		for(int i = run > 2 ? run - 2 : 0; i < run; i++)
+		{
+			last[port == BULK_VMDATA ? (done + i) & 1 : 0] = bytes[i];
+		}
+
+		data_bus->open_value = bytes[run - 1];
+		done += run;
+	}
+
+	write_register_raw(data_bus, B_BUS_ADDR | dma->DMA_B_addr[channel], last[0]);
+
+	if(port == BULK_VMDATA)
+	{
+		write_register_raw(data_bus, (B_BUS_ADDR | dma->DMA_B_addr[channel]) + 1, last[1]);
+	}
+
+	size -= count;
+
+	dma->DMA_size_or_indirect[channel] &= 0xFFFF0000;
+	dma->DMA_size_or_indirect[channel] |= size;
+
+	dma->queued_cycles += 8 * count;
+
+	return count / unit;
+}
+
+void MDMA_step(struct data_bus *data_bus, int channel)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
+
+	if(dma->MDMA_channel_over)
+	{
+		TRACE_EVENT(TRACE_DMA, TRACE_DMA_START, dma->DMA_source_addr[channel], channel);
+		dma->queued_cycles += 8;
+	}
+
+	dma->MDMA_channel_over = 0;
+
+	if(!MDMA_bulk(data_bus, channel))
+	{
+		transfer_unit(data_bus, channel);
 	}
 
-	return check;
+	if((dma->DMA_size_or_indirect[channel] & 0x0000FFFF) <= 0)
+	{
+		dma->MDMA_enable[channel] = 0;
+		dma->MDMA_channel_over = 1;
+	}
 }
 
 void DMA_transfers(struct data_bus *data_bus, int alignment)
@@ -355,27 +811,14 @@ void DMA_transfers(struct data_bus *data_bus, int alignment)
 
 
 	// cannot transfer from wram -> wram
-	int priority_HDMA = -1;
+	// HDMA runs from the PPU at H-blank, see run_HDMA_line
 	int priority_MDMA = -1;
 
 	int i = 0;
 
 	while(i < N_CHANNELS)
 	{
-		if(dma->HDMA_enable[i] && dma->HDMA_allowed && priority_HDMA == -1 && dma->HDMA_channels_finished[i] == 0)
-		{
-			priority_HDMA = i;
-
-			if(!dma->dma_active)
-			{
-				dma->queued_cycles += 8 - alignment;
-			}
-
-			dma->dma_active = 1;
-			dma->MDMA_enable[i] = 0;
-			dma->MDMA_channel_over = 1;
-		}
-		else if(dma->MDMA_enable[i] && priority_MDMA == -1)
+		if(dma->MDMA_enable[i] && priority_MDMA == -1)
 		{
 			priority_MDMA = i;
 
@@ -390,16 +833,7 @@ void DMA_transfers(struct data_bus *data_bus, int alignment)
 		i++;
 	}
 
-	if(priority_HDMA > -1)
-	{
-		if(check_new_HDMA(dma))
-		{
-			dma->queued_cycles += 18;
-		}
-
-		HDMA_step(data_bus, priority_HDMA);
-	}
-	else if(priority_MDMA > -1)
+	if(priority_MDMA > -1)
 	{
 		if(dma->new_MDMA_transfer)
 		{
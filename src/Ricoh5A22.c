@@ -1,11 +1,16 @@
 #include "ricoh5A22.h"
 #include "memory.h"
+#include "DMA.h"
+#include "scheduler.h"
 #include "utility.h"
 
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+static void select_opcode_table(struct Ricoh_5A22 *cpu);
 
 void print_cpu(struct Ricoh_5A22 *cpu)
 {
@@ -67,6 +72,8 @@ void swap_cpu_status(struct Ricoh_5A22 *cpu, uint8_t new_flags)
 		cpu->register_X &= 0x00FF;
 		cpu->register_Y &= 0x00FF;
 	}
+
+	select_opcode_table(cpu);
 }
 
 int accumulator_size(struct Ricoh_5A22 *cpu)
@@ -95,9 +102,9 @@ int index_size(struct Ricoh_5A22 *cpu)
 }
 
 
-#define get_A(cpu) ((accumulator_size(cpu) == 8) ? LE_LBYTE16(cpu->register_A) : cpu->register_A)
-#define get_X(cpu) ((index_size(cpu) == 8) ? LE_LBYTE16(cpu->register_X) : cpu->register_X)
-#define get_Y(cpu) ((index_size(cpu) == 8) ? LE_LBYTE16(cpu->register_Y) : cpu->register_Y)
+#define get_A_sized(cpu, size) ((size == 8) ? LE_LBYTE16(cpu->register_A) : cpu->register_A)
+#define get_X_sized(cpu, size) ((size == 8) ? LE_LBYTE16(cpu->register_X) : cpu->register_X)
+#define get_Y_sized(cpu, size) ((size == 8) ? LE_LBYTE16(cpu->register_Y) : cpu->register_Y)
 #define get_SP(cpu) (check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E) ? SWP_LE_HBYTE16(cpu->stack_ptr, 0x01) : cpu->stack_ptr)
 
 void decrement_SP(struct Ricoh_5A22 *cpu, int n)
@@ -148,7 +155,7 @@ uint32_t addr_ABS(struct data_bus *data_bus)
 	return addr;
 }
 
-uint32_t addr_ABS_IIX(struct data_bus *data_bus)
+static inline uint32_t addr_ABS_IIX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;	
 
@@ -159,8 +166,8 @@ uint32_t addr_ABS_IIX(struct data_bus *data_bus)
 	//
 	uint32_t addr = LE_COMBINE_BANK_2BYTE(cpu->data_bank, DB_read(data_bus, oper), DB_read(data_bus, oper + 1));
 
-	addr += get_X(cpu);
-	if(index_size(cpu) == 8 && ((addr & 0xff00) != ((addr - get_X(cpu)) & 0xff00)))
+	addr += get_X_sized(cpu, x_size);
+	if(x_size == 8 && ((addr & 0xff00) != ((addr - get_X_sized(cpu, x_size)) & 0xff00)))
 	{
 		add_internal_operation(data_bus);
 	}
@@ -171,7 +178,14 @@ uint32_t addr_ABS_IIX(struct data_bus *data_bus)
 	return addr;
 }
 
-uint32_t addr_ABS_IIY(struct data_bus *data_bus)
+uint32_t addr_ABS_IIX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_ABS_IIX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline uint32_t addr_ABS_IIY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -179,8 +193,8 @@ uint32_t addr_ABS_IIY(struct data_bus *data_bus)
 
 	uint32_t addr = LE_COMBINE_BANK_2BYTE(cpu->data_bank, DB_read(data_bus, oper), DB_read(data_bus, oper + 1));
 
-	addr += get_Y(cpu);
-	if(index_size(cpu) == 8 && ((addr & 0xff00) != ((addr - get_Y(cpu)) & 0xff00)))
+	addr += get_Y_sized(cpu, x_size);
+	if(x_size == 8 && ((addr & 0xff00) != ((addr - get_Y_sized(cpu, x_size)) & 0xff00)))
 	{
 		add_internal_operation(data_bus);
 	}
@@ -190,6 +204,13 @@ uint32_t addr_ABS_IIY(struct data_bus *data_bus)
 	return addr;
 }
 
+uint32_t addr_ABS_IIY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_ABS_IIY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 uint32_t addr_ABS_L(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -202,7 +223,7 @@ uint32_t addr_ABS_L(struct data_bus *data_bus)
 	return addr;
 }
 
-uint32_t addr_ABS_LIX(struct data_bus *data_bus)
+static inline uint32_t addr_ABS_LIX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -212,13 +233,20 @@ uint32_t addr_ABS_LIX(struct data_bus *data_bus)
 	// CHECK FOR OVERFLOWS
 	//
 
-	uint32_t addr = LE_COMBINE_3BYTE(DB_read(data_bus, oper), DB_read(data_bus, oper + 1), DB_read(data_bus, oper + 2)) + get_X(cpu);
+	uint32_t addr = LE_COMBINE_3BYTE(DB_read(data_bus, oper), DB_read(data_bus, oper + 1), DB_read(data_bus, oper + 2)) + get_X_sized(cpu, x_size);
 
 	cpu->program_ctr += 3;
 
 	return addr;
 }
 
+uint32_t addr_ABS_LIX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_ABS_LIX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 uint32_t addr_ABS_I(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -246,7 +274,7 @@ uint32_t addr_ABS_IL(struct data_bus *data_bus)
 	return addr_indirect;
 }
 
-uint32_t addr_ABS_II(struct data_bus *data_bus)
+static inline uint32_t addr_ABS_II_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -256,7 +284,7 @@ uint32_t addr_ABS_II(struct data_bus *data_bus)
 	// CHECK FOR OVERFLOWS
 	//
 
-	uint32_t addr = LE_COMBINE_2BYTE(DB_read(data_bus, oper), DB_read(data_bus, oper + 1)) + get_X(cpu);
+	uint32_t addr = LE_COMBINE_2BYTE(DB_read(data_bus, oper), DB_read(data_bus, oper + 1)) + get_X_sized(cpu, x_size);
 	uint32_t addr_indirect = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
 	uint32_t addr_effective = LE_COMBINE_BANK_SHORT(cpu->program_bank, addr_indirect);
 
@@ -265,6 +293,13 @@ uint32_t addr_ABS_II(struct data_bus *data_bus)
 	return addr_effective;
 }
 
+uint32_t addr_ABS_II(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_ABS_II_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 uint32_t addr_DIR(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -303,7 +338,7 @@ uint32_t addr_STK_R(struct data_bus *data_bus)
 	return addr;
 }
 
-uint32_t addr_DIR_IX(struct data_bus *data_bus)
+static inline uint32_t addr_DIR_IX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -321,7 +356,7 @@ uint32_t addr_DIR_IX(struct data_bus *data_bus)
 		add_internal_operation(data_bus);
 	}
 
-	addr += get_X(cpu);
+	addr += get_X_sized(cpu, x_size);
 	add_internal_operation(data_bus);
 
 	cpu->program_ctr += 1;
@@ -329,7 +364,14 @@ uint32_t addr_DIR_IX(struct data_bus *data_bus)
 	return addr;
 }
 
-uint32_t addr_DIR_IY(struct data_bus *data_bus)
+uint32_t addr_DIR_IX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_DIR_IX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline uint32_t addr_DIR_IY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -347,7 +389,7 @@ uint32_t addr_DIR_IY(struct data_bus *data_bus)
 		add_internal_operation(data_bus);
 	}
 
-	addr += get_Y(cpu);
+	addr += get_Y_sized(cpu, x_size);
 	add_internal_operation(data_bus);
 
 	cpu->program_ctr += 1;
@@ -355,6 +397,13 @@ uint32_t addr_DIR_IY(struct data_bus *data_bus)
 	return addr;
 }
 
+uint32_t addr_DIR_IY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_DIR_IY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 uint32_t addr_DIR_I(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -405,7 +454,7 @@ uint32_t addr_DIR_IL(struct data_bus *data_bus)
 	return addr_effective;
 }
 
-uint32_t addr_STK_RII(struct data_bus *data_bus)
+static inline uint32_t addr_STK_RII_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -421,7 +470,7 @@ uint32_t addr_STK_RII(struct data_bus *data_bus)
 	add_internal_operation(data_bus);
 	
 	uint32_t addr_base = LE_COMBINE_BANK_2BYTE(cpu->data_bank, DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-	uint32_t addr_effective = addr_base + get_Y(cpu);
+	uint32_t addr_effective = addr_base + get_Y_sized(cpu, x_size);
 	add_internal_operation(data_bus);
 
 	cpu->program_ctr += 1;
@@ -429,7 +478,14 @@ uint32_t addr_STK_RII(struct data_bus *data_bus)
 	return addr_effective;
 }
 
-uint32_t addr_DIR_IIX(struct data_bus *data_bus)
+uint32_t addr_STK_RII(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_STK_RII_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline uint32_t addr_DIR_IIX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -447,7 +503,7 @@ uint32_t addr_DIR_IIX(struct data_bus *data_bus)
 		add_internal_operation(data_bus);
 	}
 
-	addr += get_X(cpu);
+	addr += get_X_sized(cpu, x_size);
 
 	uint32_t addr_indirect = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
 
@@ -458,7 +514,14 @@ uint32_t addr_DIR_IIX(struct data_bus *data_bus)
 	return addr_effective;
 }
 
-uint32_t addr_DIR_IIY(struct data_bus *data_bus)
+uint32_t addr_DIR_IIX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_DIR_IIX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline uint32_t addr_DIR_IIY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -478,8 +541,8 @@ uint32_t addr_DIR_IIY(struct data_bus *data_bus)
 
 	uint32_t addr_indirect = LE_COMBINE_BANK_2BYTE(cpu->data_bank, DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
 
-	uint32_t addr_effective = addr_indirect + get_Y(cpu);
-	if(index_size(cpu) == 8 && ((addr_indirect & 0xff00) != (addr_effective & 0xff00)))
+	uint32_t addr_effective = addr_indirect + get_Y_sized(cpu, x_size);
+	if(x_size == 8 && ((addr_indirect & 0xff00) != (addr_effective & 0xff00)))
 	{
 		add_internal_operation(data_bus);
 	}
@@ -489,7 +552,14 @@ uint32_t addr_DIR_IIY(struct data_bus *data_bus)
 	return addr_effective;
 }
 
-uint32_t addr_DIR_ILI(struct data_bus *data_bus)
+uint32_t addr_DIR_IIY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_DIR_IIY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline uint32_t addr_DIR_ILI_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -501,13 +571,20 @@ uint32_t addr_DIR_ILI(struct data_bus *data_bus)
 
 	uint32_t addr = cpu->direct_page + DB_read(data_bus, oper);
 	uint32_t addr_indirect = LE_COMBINE_3BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1), DB_read(data_bus, addr + 2));
-	uint32_t addr_effective = addr_indirect + get_Y(cpu);
+	uint32_t addr_effective = addr_indirect + get_Y_sized(cpu, x_size);
 
 	cpu->program_ctr += 1;
 
 	return addr_effective;
 }
 
+uint32_t addr_DIR_ILI(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_DIR_ILI_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 uint32_t addr_REL(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -552,13 +629,13 @@ uint32_t addr_IMM_16(struct data_bus *data_bus)
 	return oper;
 }
 
-uint32_t addr_IMM_M(struct data_bus *data_bus)
+static inline uint32_t addr_IMM_M_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	uint32_t oper = LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr);
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		cpu->program_ctr += 1;
 	}
@@ -570,13 +647,20 @@ uint32_t addr_IMM_M(struct data_bus *data_bus)
 	return oper;
 }
 
-uint32_t addr_IMM_X(struct data_bus *data_bus)
+uint32_t addr_IMM_M(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_IMM_M_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline uint32_t addr_IMM_X_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	uint32_t oper = LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		cpu->program_ctr += 1;
 	}
@@ -588,6 +672,13 @@ uint32_t addr_IMM_X(struct data_bus *data_bus)
 	return oper;
 }
 
+uint32_t addr_IMM_X(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	return addr_IMM_X_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 uint32_t addr_XYC(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -599,16 +690,16 @@ uint32_t addr_XYC(struct data_bus *data_bus)
 	return oper;
 }
 
-void ADC(struct data_bus *data_bus, uint32_t addr)
+static inline void ADC_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		if(check_bit8(cpu->cpu_status, CPU_STATUS_D))
 		{
 			uint8_t operand = DB_read(data_bus, addr);
-			uint32_t wide_acc = (uint32_t)get_A(cpu) & 0x000000FF;
+			uint32_t wide_acc = (uint32_t)get_A_sized(cpu, m_size) & 0x000000FF;
 
 			uint32_t sum = (wide_acc & 0x0000000F) + (operand & 0x0F) + check_bit8(cpu->cpu_status, CPU_STATUS_C);
 
@@ -620,7 +711,7 @@ void ADC(struct data_bus *data_bus, uint32_t addr)
 			sum += (wide_acc & 0x000000F0) + (operand & 0xF0);
 
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((~(wide_acc ^ operand)) & (wide_acc ^ sum), 0x00000080));
-			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint8_t)sum ^ get_A(cpu), 0x00000080));
+			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint8_t)sum ^ get_A_sized(cpu, m_size), 0x00000080));
 
 			if(sum > 0x99)
 			{
@@ -636,13 +727,13 @@ void ADC(struct data_bus *data_bus, uint32_t addr)
 		else 
 		{
 			uint8_t operand = DB_read(data_bus, addr);
-			uint32_t wide_acc = (uint32_t)get_A(cpu) & 0x000000FF;
+			uint32_t wide_acc = (uint32_t)get_A_sized(cpu, m_size) & 0x000000FF;
 
 			uint32_t sum = wide_acc + operand + check_bit8(cpu->cpu_status, CPU_STATUS_C);
 			
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit32(sum, 0x00000080));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((~(wide_acc ^ operand)) & (wide_acc ^ sum), 0x00000080));
-			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint8_t)sum ^ get_A(cpu), 0x00000080));
+			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint8_t)sum ^ get_A_sized(cpu, m_size), 0x00000080));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_C, check_bit32(sum, 0x00000100));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, ((uint8_t)sum == 0));
 
@@ -655,7 +746,7 @@ void ADC(struct data_bus *data_bus, uint32_t addr)
 		{
 
 			uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-			uint32_t wide_acc = (uint32_t)get_A(cpu) & 0x0000FFFF;
+			uint32_t wide_acc = (uint32_t)get_A_sized(cpu, m_size) & 0x0000FFFF;
 
 			uint32_t sum = (wide_acc & 0x0000000F) + (operand & 0x000F) + check_bit8(cpu->cpu_status, CPU_STATUS_C);
 	
@@ -680,7 +771,7 @@ void ADC(struct data_bus *data_bus, uint32_t addr)
 
 			sum += (wide_acc & 0x0000F000) + (operand & 0xF000);
 
-			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint16_t)sum ^ get_A(cpu), 0x00008000));
+			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint16_t)sum ^ get_A_sized(cpu, m_size), 0x00008000));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((~(wide_acc ^ operand)) & (wide_acc ^ sum), 0x00008000));
 
 			if(sum > 0x9999)
@@ -697,13 +788,13 @@ void ADC(struct data_bus *data_bus, uint32_t addr)
 		else 
 		{
 			uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-			uint32_t wide_acc = (uint32_t)get_A(cpu) & 0x0000FFFF;
+			uint32_t wide_acc = (uint32_t)get_A_sized(cpu, m_size) & 0x0000FFFF;
 
 			uint32_t sum = wide_acc + operand + check_bit8(cpu->cpu_status, CPU_STATUS_C);
 
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit32(sum , 0x00008000));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((~(wide_acc ^ operand)) & (wide_acc ^ sum), 0x00008000));
-			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint16_t)sum ^ get_A(cpu), 0x00008000));
+			// BIT_SECL(cpu->cpu_status, CPU_STATUS_V, check_bit32((uint16_t)sum ^ get_A_sized(cpu, m_size), 0x00008000));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_C, check_bit32(sum , 0x00010000));
 			BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, ((uint16_t)sum == 0));
 
@@ -712,14 +803,21 @@ void ADC(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void AND(struct data_bus *data_bus, uint32_t addr)
+void ADC(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	ADC_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void AND_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 
 		uint8_t result = accumulator & operand;
 
@@ -731,7 +829,7 @@ void AND(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 
 		uint16_t result = accumulator & operand;
 
@@ -742,11 +840,18 @@ void AND(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void ASL(struct data_bus *data_bus, uint32_t addr)
+void AND(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	AND_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void ASL_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 
@@ -779,13 +884,20 @@ void ASL(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void ASL_A(struct data_bus *data_bus)
+void ASL(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	ASL_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void ASL_A_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 	
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
-		uint8_t operand = get_A(cpu);
+		uint8_t operand = get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_C, check_bit8(operand, 0x80));
 		
@@ -800,7 +912,7 @@ void ASL_A(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t operand = get_A(cpu);
+		uint16_t operand = get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_C, check_bit16(operand, 0x8000));
 
@@ -815,6 +927,13 @@ void ASL_A(struct data_bus *data_bus)
 	}
 }
 
+void ASL_A(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	ASL_A_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void BCC(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -875,14 +994,14 @@ void BEQ(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void BIT(struct data_bus *data_bus, uint32_t addr)
+static inline void BIT_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 
 		uint8_t test = accumulator & operand;
 
@@ -893,7 +1012,7 @@ void BIT(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 
 		uint16_t test = accumulator & operand;
 
@@ -903,14 +1022,21 @@ void BIT(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void BIT_IMM(struct data_bus *data_bus, uint32_t addr)
+void BIT(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	BIT_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void BIT_IMM_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 
 		uint8_t test = accumulator & operand;
 
@@ -919,7 +1045,7 @@ void BIT_IMM(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 
 		uint16_t test = accumulator & operand;
 
@@ -927,6 +1053,13 @@ void BIT_IMM(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
+void BIT_IMM(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	BIT_IMM_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void BMI(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -1011,8 +1144,6 @@ void BRK(struct data_bus *data_bus)
 	cpu->program_ctr++; // signature
 	DB_read(data_bus, LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr));
 
-	cpu->NMI_line = 1;
-
 	if(check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E))
 	{
 		push_SP(data_bus, LE_HBYTE16(cpu->program_ctr));
@@ -1127,14 +1258,14 @@ void CLV(struct data_bus *data_bus)
 	cpu->cpu_status &= ~CPU_STATUS_V;
 }
 
-void CMP(struct data_bus *data_bus, uint32_t addr)
+static inline void CMP_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 
 		uint8_t result = accumulator - operand;
 
@@ -1145,7 +1276,7 @@ void CMP(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 
 		uint16_t result = accumulator - operand;
 
@@ -1155,6 +1286,13 @@ void CMP(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
+void CMP(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	CMP_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void COP(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -1190,14 +1328,14 @@ void COP(struct data_bus *data_bus)
 	}
 }
 
-void CPX(struct data_bus *data_bus, uint32_t addr)
+static inline void CPX_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t index = get_X(cpu);
+		uint8_t index = get_X_sized(cpu, x_size);
 
 		uint8_t result = index - operand;
 
@@ -1208,7 +1346,7 @@ void CPX(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t index = get_X(cpu);
+		uint16_t index = get_X_sized(cpu, x_size);
 
 		uint16_t result = index - operand;
 
@@ -1218,14 +1356,21 @@ void CPX(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void CPY(struct data_bus *data_bus, uint32_t addr)
+void CPX(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	CPX_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void CPY_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(x_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t index = get_Y(cpu);
+		uint8_t index = get_Y_sized(cpu, x_size);
 
 		uint8_t result = index - operand;
 
@@ -1236,7 +1381,7 @@ void CPY(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t index = get_Y(cpu);
+		uint16_t index = get_Y_sized(cpu, x_size);
 
 		int16_t result = index - operand;
 
@@ -1246,11 +1391,18 @@ void CPY(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void DEC(struct data_bus *data_bus, uint32_t addr)
+void CPY(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	CPY_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void DEC_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 		
@@ -1279,13 +1431,20 @@ void DEC(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void DEC_A(struct data_bus *data_bus)
+void DEC(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	DEC_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void DEC_A_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 	
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
-		uint8_t operand = get_A(cpu);
+		uint8_t operand = get_A_sized(cpu, m_size);
 		
 		uint8_t result = operand - 1;
 
@@ -1298,7 +1457,7 @@ void DEC_A(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t operand = get_A(cpu);
+		uint16_t operand = get_A_sized(cpu, m_size);
 
 		uint16_t result = operand - 1;
 
@@ -1311,15 +1470,22 @@ void DEC_A(struct data_bus *data_bus)
 	}
 }
 
-void DEX(struct data_bus *data_bus)
+void DEC_A(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	DEC_A_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void DEX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t index = get_X(cpu);
+		uint8_t index = get_X_sized(cpu, x_size);
 		uint8_t result = index - 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit8(result, 0x80));
@@ -1329,7 +1495,7 @@ void DEX(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t index = get_X(cpu);
+		uint16_t index = get_X_sized(cpu, x_size);
 		uint16_t result = index - 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit16(result, 0x8000));
@@ -1339,15 +1505,22 @@ void DEX(struct data_bus *data_bus)
 	}
 }
 
-void DEY(struct data_bus *data_bus)
+void DEX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	DEX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void DEY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t index = get_Y(cpu);
+		uint8_t index = get_Y_sized(cpu, x_size);
 		uint8_t result = index - 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit8(result, 0x80));
@@ -1357,7 +1530,7 @@ void DEY(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t index = get_Y(cpu);
+		uint16_t index = get_Y_sized(cpu, x_size);
 		uint16_t result = index - 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit16(result, 0x8000));
@@ -1367,14 +1540,21 @@ void DEY(struct data_bus *data_bus)
 	}
 }
 
-void EOR(struct data_bus *data_bus, uint32_t addr)
+void DEY(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	DEY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void EOR_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 
 		uint8_t result = operand ^ accumulator;
 
@@ -1386,7 +1566,7 @@ void EOR(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 
 		uint16_t result = operand ^ accumulator;
 
@@ -1397,11 +1577,18 @@ void EOR(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void INC(struct data_bus *data_bus, uint32_t addr)
+void EOR(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	EOR_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void INC_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 		
@@ -1430,13 +1617,20 @@ void INC(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void INC_A(struct data_bus *data_bus)
+void INC(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	INC_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void INC_A_sized(struct data_bus *data_bus, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
-		uint8_t operand = get_A(cpu);
+		uint8_t operand = get_A_sized(cpu, m_size);
 		
 		uint8_t result = operand + 1;
 
@@ -1449,7 +1643,7 @@ void INC_A(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t operand = get_A(cpu);
+		uint16_t operand = get_A_sized(cpu, m_size);
 
 		uint16_t result = operand + 1;
 
@@ -1462,15 +1656,22 @@ void INC_A(struct data_bus *data_bus)
 	}
 }
 
-void INX(struct data_bus *data_bus)
+void INC_A(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	INC_A_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void INX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t index = get_X(cpu);
+		uint8_t index = get_X_sized(cpu, x_size);
 		uint8_t result = index + 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit8(result, 0x80));
@@ -1480,7 +1681,7 @@ void INX(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t index = get_X(cpu);
+		uint16_t index = get_X_sized(cpu, x_size);
 		uint16_t result = index + 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit16(result, 0x8000));
@@ -1490,15 +1691,22 @@ void INX(struct data_bus *data_bus)
 	}
 }
 
-void INY(struct data_bus *data_bus)
+void INX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	INX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void INY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t index = get_Y(cpu);
+		uint8_t index = get_Y_sized(cpu, x_size);
 		uint8_t result = index + 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit8(result, 0x80));
@@ -1508,7 +1716,7 @@ void INY(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t index = get_Y(cpu);
+		uint16_t index = get_Y_sized(cpu, x_size);
 		uint16_t result = index + 1;
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit16(result, 0x8000));
@@ -1518,6 +1726,13 @@ void INY(struct data_bus *data_bus)
 	}
 }
 
+void INY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	INY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void JMP(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -1552,11 +1767,11 @@ void JSL(struct data_bus *data_bus, uint32_t addr)
 	cpu->program_ctr = addr & 0x0000FFFF;
 }
 
-void LDA(struct data_bus *data_bus, uint32_t addr)
+static inline void LDA_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 
@@ -1576,11 +1791,18 @@ void LDA(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void LDX(struct data_bus *data_bus, uint32_t addr)
+void LDA(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	LDA_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void LDX_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 
@@ -1600,11 +1822,18 @@ void LDX(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void LDY(struct data_bus *data_bus, uint32_t addr)
+void LDX(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	LDX_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void LDY_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(x_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 
@@ -1624,11 +1853,18 @@ void LDY(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void LSR(struct data_bus *data_bus, uint32_t addr)
+void LDY(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	LDY_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void LSR_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 
@@ -1661,13 +1897,20 @@ void LSR(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void LSR_A(struct data_bus *data_bus)
+void LSR(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	LSR_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void LSR_A_sized(struct data_bus *data_bus, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
-		uint8_t operand = get_A(cpu);
+		uint8_t operand = get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_C, check_bit8(operand, 0x01));
 
@@ -1683,7 +1926,7 @@ void LSR_A(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t operand = get_A(cpu);
+		uint16_t operand = get_A_sized(cpu, m_size);
 		
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_C, check_bit8(operand, 0x0001));
 
@@ -1692,13 +1935,87 @@ void LSR_A(struct data_bus *data_bus)
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit16(result, 0x8000));
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (result == 0));
 
-		add_internal_operation(data_bus);
+		add_internal_operation(data_bus);
+
+		cpu->register_A = result;
+	}
+}
+
+void LSR_A(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	LSR_A_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+// carries on a block move that is past its first byte without going back through run_step. every byte 
+// costs what a whole MVN/MVP step would, so it stops before a step would end past the next event, and on 
+// anything a step can't repeat by itself: registers, open bus or ROM, or writing over its own operands.
+// the count is always the full 16-bit C, whatever M is
+static inline void block_move(struct data_bus *data_bus, uint8_t src_bank, const int x_size, const int step)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct Scheduler *scheduler = data_bus->scheduler;
+	struct page *page_table = data_bus->A_Bus.memory->page_table;
+
+	if(cpu->NMI_line == 0 || (cpu->IRQ_line == 0 && !check_bit8(cpu->cpu_status, CPU_STATUS_I)) || cpu->REFRESH || data_bus->B_bus.dma->dma_active)
+	{
+		return;
+	}
+
+	uint32_t opcode_addr = LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr);
+	uint32_t operand_addr = LE_COMBINE_BANK_SHORT(cpu->program_bank, (uint16_t)(cpu->program_ctr + 2));
+
+	uint8_t *code_ptr = page_table[PAGE_INDEX(opcode_addr)].ptr;
+	uint8_t *operand_ptr = page_table[PAGE_INDEX(operand_addr)].ptr;
+
+	uint64_t fetch_cycles = bus_cycles(data_bus, opcode_addr) + 
+							bus_cycles(data_bus, LE_COMBINE_BANK_SHORT(cpu->program_bank, (uint16_t)(cpu->program_ctr + 1))) + 
+							bus_cycles(data_bus, operand_addr);
+
+	uint64_t clock = scheduler->master_clock + cpu->queued_cyles; // the next step would start here
+
+	while(cpu->register_A != 0xFFFF)
+	{
+		uint32_t src_addr = LE_COMBINE_BANK_SHORT(src_bank, get_X_sized(cpu, x_size));
+		uint32_t dst_addr = LE_COMBINE_BANK_SHORT(cpu->data_bank, get_Y_sized(cpu, x_size));
+
+		struct page *src_page = &page_table[PAGE_INDEX(src_addr)];
+		struct page *dst_page = &page_table[PAGE_INDEX(dst_addr)];
+
+		if(!src_page->ptr || dst_page->type != PAGE_RAM || dst_page->ptr == code_ptr || dst_page->ptr == operand_ptr)
+		{
+			break;
+		}
+
+		uint64_t cycles = fetch_cycles + bus_cycles(data_bus, src_addr) + bus_cycles(data_bus, dst_addr) + 12; // + 2 internal operations
+
+		if(clock + cycles > scheduler->event_clock)
+		{
+			break;
+		}
+
+		write_page(data_bus, dst_page, dst_addr, read_page(data_bus, src_page, src_addr));
+
+		if(x_size == 8)
+		{
+			cpu->register_X = SWP_LE_LBYTE16(cpu->register_X, (uint8_t)(get_X_sized(cpu, x_size) + step));
+			cpu->register_Y = SWP_LE_LBYTE16(cpu->register_Y, (uint8_t)(get_Y_sized(cpu, x_size) + step));
+		}
+		else 
+		{
+			cpu->register_X = get_X_sized(cpu, x_size) + step;
+			cpu->register_Y = get_Y_sized(cpu, x_size) + step;
+		}
+
+		cpu->register_A--;
 
-		cpu->register_A = result;
+		cpu->queued_cyles += cycles;
+		clock += cycles;
 	}
 }
 
-void MVN(struct data_bus *data_bus, uint32_t addr)
+static inline void MVN_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -1707,39 +2024,48 @@ void MVN(struct data_bus *data_bus, uint32_t addr)
 
 	cpu->data_bank = dst_bank;
 
-	uint32_t src_addr = LE_COMBINE_BANK_SHORT(src_bank, get_X(cpu));
-	uint32_t dst_addr = LE_COMBINE_BANK_SHORT(cpu->data_bank, get_Y(cpu));
+	uint32_t src_addr = LE_COMBINE_BANK_SHORT(src_bank, get_X_sized(cpu, x_size));
+	uint32_t dst_addr = LE_COMBINE_BANK_SHORT(cpu->data_bank, get_Y_sized(cpu, x_size));
 
-	if(get_A(cpu) != 0xFFFF)
+	if(cpu->register_A != 0xFFFF)
 	{
 		uint8_t read_byte = DB_read(data_bus, src_addr);
 		DB_write(data_bus, dst_addr, read_byte);
 
 		cpu->program_ctr -= 3;
 
-		if(index_size(cpu) == 8)
+		if(x_size == 8)
 		{
-			cpu->register_X = SWP_LE_LBYTE16(cpu->register_X, (uint8_t)get_X(cpu) + 1);
+			cpu->register_X = SWP_LE_LBYTE16(cpu->register_X, (uint8_t)(get_X_sized(cpu, x_size) + 1));
 			add_internal_operation(data_bus);
 
-			cpu->register_Y = SWP_LE_LBYTE16(cpu->register_Y, (uint8_t)get_Y(cpu) + 1);
+			cpu->register_Y = SWP_LE_LBYTE16(cpu->register_Y, (uint8_t)(get_Y_sized(cpu, x_size) + 1));
 			add_internal_operation(data_bus);
 		}
 		else 
 		{	
-			cpu->register_X = get_X(cpu) + 1;
+			cpu->register_X = get_X_sized(cpu, x_size) + 1;
 			add_internal_operation(data_bus);
 		
-			cpu->register_Y = get_Y(cpu) + 1;
+			cpu->register_Y = get_Y_sized(cpu, x_size) + 1;
 			add_internal_operation(data_bus);
 		}
 
 
 		cpu->register_A--;
+
+		block_move(data_bus, src_bank, x_size, 1);
 	}
 }
 
-void MVP(struct data_bus *data_bus, uint32_t addr)
+void MVN(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	MVN_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void MVP_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -1748,37 +2074,46 @@ void MVP(struct data_bus *data_bus, uint32_t addr)
 
 	cpu->data_bank = dst_bank;
 
-	uint32_t src_addr = LE_COMBINE_BANK_SHORT(src_bank, get_X(cpu));
-	uint32_t dst_addr = LE_COMBINE_BANK_SHORT(cpu->data_bank, get_Y(cpu));
+	uint32_t src_addr = LE_COMBINE_BANK_SHORT(src_bank, get_X_sized(cpu, x_size));
+	uint32_t dst_addr = LE_COMBINE_BANK_SHORT(cpu->data_bank, get_Y_sized(cpu, x_size));
 
-	if(get_A(cpu) != 0xFFFF)
+	if(cpu->register_A != 0xFFFF)
 	{
 		uint8_t read_byte = DB_read(data_bus, src_addr);
 		DB_write(data_bus, dst_addr, read_byte);
 
 		cpu->program_ctr -= 3;
 
-		if(index_size(cpu) == 8)
+		if(x_size == 8)
 		{
-			cpu->register_X = SWP_LE_LBYTE16(cpu->register_X, (uint8_t)get_X(cpu) - 1);
+			cpu->register_X = SWP_LE_LBYTE16(cpu->register_X, (uint8_t)(get_X_sized(cpu, x_size) - 1));
 			add_internal_operation(data_bus);
 			
-			cpu->register_Y = SWP_LE_LBYTE16(cpu->register_Y, (uint8_t)get_Y(cpu) - 1);
+			cpu->register_Y = SWP_LE_LBYTE16(cpu->register_Y, (uint8_t)(get_Y_sized(cpu, x_size) - 1));
 			add_internal_operation(data_bus);
 		}
 		else 
 		{	
-			cpu->register_X = get_X(cpu) - 1;
+			cpu->register_X = get_X_sized(cpu, x_size) - 1;
 			add_internal_operation(data_bus);
 
-			cpu->register_Y = get_Y(cpu) - 1;
+			cpu->register_Y = get_Y_sized(cpu, x_size) - 1;
 			add_internal_operation(data_bus);
 		}
 
 		cpu->register_A--;
+
+		block_move(data_bus, src_bank, x_size, -1);
 	}
 }
 
+void MVP(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	MVP_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void NOP(struct data_bus *data_bus)
 {
 	add_internal_operation(data_bus);
@@ -1786,14 +2121,14 @@ void NOP(struct data_bus *data_bus)
 	return;
 }
 
-void ORA(struct data_bus *data_bus, uint32_t addr)
+static inline void ORA_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 
 		uint8_t result = operand | accumulator;
 
@@ -1805,7 +2140,7 @@ void ORA(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 
 		uint16_t result = operand | accumulator;
 
@@ -1816,6 +2151,13 @@ void ORA(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
+void ORA(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	ORA_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void PEA(struct data_bus *data_bus, uint32_t addr)
 {
 	uint8_t addr_l = (uint8_t)(addr & 0x000000FF);
@@ -1851,20 +2193,20 @@ void PER(struct data_bus *data_bus, uint32_t addr)
 	push_SP(data_bus, LE_LBYTE16(operand));
 }
 
-void PHA(struct data_bus *data_bus)
+static inline void PHA_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 		add_internal_operation(data_bus);
 
 		push_SP(data_bus, accumulator);
 	}
 	else 
 	{
-		uint16_t accumulator = get_A(cpu);
+		uint16_t accumulator = get_A_sized(cpu, m_size);
 		add_internal_operation(data_bus);
 
 		uint8_t acc_h = LE_HBYTE16(accumulator);
@@ -1875,6 +2217,13 @@ void PHA(struct data_bus *data_bus)
 	}
 }
 
+void PHA(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	PHA_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void PHB(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -1917,20 +2266,20 @@ void PHP(struct data_bus *data_bus)
 	push_SP(data_bus, cpu_status);
 }
 
-void PHX(struct data_bus *data_bus)
+static inline void PHX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t index = get_X(cpu);
+		uint8_t index = get_X_sized(cpu, x_size);
 		add_internal_operation(data_bus);
 
 		push_SP(data_bus, index);
 	}
 	else 
 	{
-		uint16_t index = get_X(cpu);
+		uint16_t index = get_X_sized(cpu, x_size);
 		add_internal_operation(data_bus);
 
 		uint8_t index_h = LE_HBYTE16(index);
@@ -1941,20 +2290,27 @@ void PHX(struct data_bus *data_bus)
 	}
 }
 
-void PHY(struct data_bus *data_bus)
+void PHX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	PHX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void PHY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t index = get_Y(cpu);
+		uint8_t index = get_Y_sized(cpu, x_size);
 		add_internal_operation(data_bus);
 
 		push_SP(data_bus, index);
 	}
 	else 
 	{
-		uint16_t index = get_Y(cpu);
+		uint16_t index = get_Y_sized(cpu, x_size);
 		add_internal_operation(data_bus);
 
 		uint8_t index_h = LE_HBYTE16(index);
@@ -1965,7 +2321,14 @@ void PHY(struct data_bus *data_bus)
 	}
 }
 
-void PLA(struct data_bus *data_bus)
+void PHY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	PHY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void PLA_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -1973,7 +2336,7 @@ void PLA(struct data_bus *data_bus)
 	add_internal_operation(data_bus);
 	add_internal_operation(data_bus);
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t accumulator = pull_SP(data_bus);
 
@@ -1996,6 +2359,13 @@ void PLA(struct data_bus *data_bus)
 	}
 }
 
+void PLA(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	PLA_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void PLB(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2041,10 +2411,10 @@ void PLP(struct data_bus *data_bus)
 
 	uint8_t cpu_status = pull_SP(data_bus);
 
-	cpu->cpu_status = cpu_status;
+	swap_cpu_status(cpu, cpu_status);
 }
 
-void PLX(struct data_bus *data_bus)
+static inline void PLX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -2052,7 +2422,7 @@ void PLX(struct data_bus *data_bus)
 	add_internal_operation(data_bus);
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		uint8_t index = pull_SP(data_bus);		
 
@@ -2075,7 +2445,14 @@ void PLX(struct data_bus *data_bus)
 	}
 }
 
-void PLY(struct data_bus *data_bus)
+void PLX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	PLX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void PLY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
@@ -2083,7 +2460,7 @@ void PLY(struct data_bus *data_bus)
 	add_internal_operation(data_bus);
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		uint8_t index = pull_SP(data_bus);
 
@@ -2106,6 +2483,13 @@ void PLY(struct data_bus *data_bus)
 	}
 }
 
+void PLY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	PLY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void REP(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2117,11 +2501,11 @@ void REP(struct data_bus *data_bus, uint32_t addr)
 	add_internal_operation(data_bus);
 }
 
-void ROL(struct data_bus *data_bus, uint32_t addr)
+static inline void ROL_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 		uint8_t result = operand << 1;
@@ -2154,13 +2538,20 @@ void ROL(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void ROL_A(struct data_bus *data_bus)
+void ROL(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	ROL_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void ROL_A_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 		uint8_t result = accumulator << 1;
 
 		BIT_SECL(result, 0x01, check_bit8(cpu->cpu_status, CPU_STATUS_C));
@@ -2190,11 +2581,18 @@ void ROL_A(struct data_bus *data_bus)
 	}
 }
 
-void ROR(struct data_bus *data_bus, uint32_t addr)
+void ROL_A(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	ROL_A_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void ROR_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
 		uint8_t result = operand >> 1;
@@ -2227,15 +2625,22 @@ void ROR(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void ROR_A(struct data_bus *data_bus)
+void ROR(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	ROR_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void ROR_A_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	cpu->queued_cyles += 6;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
-		uint8_t accumulator = get_A(cpu);
+		uint8_t accumulator = get_A_sized(cpu, m_size);
 		uint8_t result = accumulator >> 1;
 
 		BIT_SECL(result, 0x80, check_bit8(cpu->cpu_status, CPU_STATUS_C));
@@ -2261,6 +2666,13 @@ void ROR_A(struct data_bus *data_bus)
 	}
 }
 
+void ROR_A(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	ROR_A_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void RTI(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2323,17 +2735,17 @@ void RTS(struct data_bus *data_bus)
 	cpu->program_ctr++;
 }
 
-void SBC(struct data_bus *data_bus, uint32_t addr)
+static inline void SBC_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		if(check_bit8(cpu->cpu_status, CPU_STATUS_D))
 		{
 			uint8_t operand = DB_read(data_bus, addr);
 			uint32_t operand_c = 0x000000FF & (~operand);
-			uint32_t wide_acc = 0x000000FF & get_A(cpu);
+			uint32_t wide_acc = 0x000000FF & get_A_sized(cpu, m_size);
 
 			uint32_t dif = wide_acc + (operand_c + 1) - (1 - check_bit8(cpu->cpu_status, CPU_STATUS_C));
 
@@ -2359,7 +2771,7 @@ void SBC(struct data_bus *data_bus, uint32_t addr)
 		{
 			uint8_t operand = DB_read(data_bus, addr);
 			uint32_t operand_c = ((uint32_t)(~operand) & 0x000000FF);
-			uint32_t wide_acc = (uint32_t)get_A(cpu) & 0x000000FF;
+			uint32_t wide_acc = (uint32_t)get_A_sized(cpu, m_size) & 0x000000FF;
 
 			uint32_t difference = wide_acc + (operand_c + 1) - (1 - check_bit8(cpu->cpu_status, CPU_STATUS_C));
 
@@ -2377,7 +2789,7 @@ void SBC(struct data_bus *data_bus, uint32_t addr)
 		{
 			uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
 			uint32_t operand_c = 0x0000FFFF & (~operand);
-			uint32_t wide_acc = 0x0000FFFF & get_A(cpu);
+			uint32_t wide_acc = 0x0000FFFF & get_A_sized(cpu, m_size);
 
 			uint32_t dif = wide_acc + (operand_c + 1) - (1 - check_bit8(cpu->cpu_status, CPU_STATUS_C));
 
@@ -2413,7 +2825,7 @@ void SBC(struct data_bus *data_bus, uint32_t addr)
 		{
 			uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
 			uint32_t operand_c = ((uint32_t)(~operand) & 0x0000FFFF);
-			uint32_t wide_acc = (uint32_t)get_A(cpu) & 0x0000FFFF;
+			uint32_t wide_acc = (uint32_t)get_A_sized(cpu, m_size) & 0x0000FFFF;
 
 			uint32_t difference = wide_acc + (operand_c + 1) - (1 - check_bit8(cpu->cpu_status, CPU_STATUS_C));
 
@@ -2427,6 +2839,13 @@ void SBC(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
+void SBC(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	SBC_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void SEC(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2464,11 +2883,11 @@ void SEP(struct data_bus *data_bus, uint32_t addr)
 	add_internal_operation(data_bus);
 }
 
-void STA(struct data_bus *data_bus, uint32_t addr)
+static inline void STA_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		DB_write(data_bus, addr, LE_LBYTE16(cpu->register_A));
 	}
@@ -2479,6 +2898,13 @@ void STA(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
+void STA(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	STA_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void STP(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2490,11 +2916,11 @@ void STP(struct data_bus *data_bus)
 	add_internal_operation(data_bus);
 }
 
-void STX(struct data_bus *data_bus, uint32_t addr)
+static inline void STX_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		DB_write(data_bus, addr, LE_LBYTE16(cpu->register_X));
 	}
@@ -2505,11 +2931,18 @@ void STX(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void STY(struct data_bus *data_bus, uint32_t addr)
+void STX(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	STX_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void STY_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		DB_write(data_bus, addr, LE_LBYTE16(cpu->register_Y));
 	}
@@ -2520,11 +2953,16 @@ void STY(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void STZ(struct data_bus *data_bus, uint32_t addr)
+void STY(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	STY_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void STZ_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
+{
+	if(m_size == 8)
 	{
 		DB_write(data_bus, addr, 0x00);
 	}
@@ -2535,13 +2973,20 @@ void STZ(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void TAX(struct data_bus *data_bus)
+void STZ(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	STZ_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void TAX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit8(LE_LBYTE16(cpu->register_A), 0x80));
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (LE_LBYTE16(cpu->register_A) == 0x00));
@@ -2557,13 +3002,20 @@ void TAX(struct data_bus *data_bus)
 	}
 }
 
-void TAY(struct data_bus *data_bus)
+void TAX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TAX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void TAY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_N, check_bit8(LE_LBYTE16(cpu->register_A), 0x80));
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (LE_LBYTE16(cpu->register_A) == 0x00));
@@ -2579,6 +3031,13 @@ void TAY(struct data_bus *data_bus)
 	}
 }
 
+void TAY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TAY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void TCD(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2620,15 +3079,15 @@ void TDC(struct data_bus *data_bus)
 	cpu->register_A = cpu->direct_page;
 }
 
-void TRB(struct data_bus *data_bus, uint32_t addr)
+static inline void TRB_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t reset = operand & (~get_A(cpu));
-		uint8_t test = operand & get_A(cpu);
+		uint8_t reset = operand & (~get_A_sized(cpu, m_size));
+		uint8_t test = operand & get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (test == 0));
 
@@ -2639,8 +3098,8 @@ void TRB(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t reset = operand & (~get_A(cpu));
-		uint16_t test = operand & get_A(cpu);
+		uint16_t reset = operand & (~get_A_sized(cpu, m_size));
+		uint16_t test = operand & get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (test == 0));
 
@@ -2651,15 +3110,22 @@ void TRB(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
-void TSB(struct data_bus *data_bus, uint32_t addr)
+void TRB(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TRB_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void TSB_sized(struct data_bus *data_bus, uint32_t addr, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t operand = DB_read(data_bus, addr);
-		uint8_t reset = operand | get_A(cpu);
-		uint8_t test = operand & get_A(cpu);
+		uint8_t reset = operand | get_A_sized(cpu, m_size);
+		uint8_t test = operand & get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (test == 0));
 
@@ -2670,8 +3136,8 @@ void TSB(struct data_bus *data_bus, uint32_t addr)
 	else 
 	{
 		uint16_t operand = LE_COMBINE_2BYTE(DB_read(data_bus, addr), DB_read(data_bus, addr + 1));
-		uint16_t reset = operand | get_A(cpu);
-		uint16_t test = operand & get_A(cpu);
+		uint16_t reset = operand | get_A_sized(cpu, m_size);
+		uint16_t test = operand & get_A_sized(cpu, m_size);
 
 		BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (test == 0));
 
@@ -2682,6 +3148,13 @@ void TSB(struct data_bus *data_bus, uint32_t addr)
 	}
 }
 
+void TSB(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TSB_sized(data_bus, addr, accumulator_size(cpu), index_size(cpu));
+}
+
 void TSC(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2694,13 +3167,13 @@ void TSC(struct data_bus *data_bus)
 	BIT_SECL(cpu->cpu_status, CPU_STATUS_Z, (get_SP(cpu) == 0x0000));
 }
 
-void TSX(struct data_bus *data_bus)
+static inline void TSX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
 		uint8_t sp = LE_LBYTE16(get_SP(cpu));
 
@@ -2720,13 +3193,20 @@ void TSX(struct data_bus *data_bus)
 	}
 }
 
-void TXA(struct data_bus *data_bus)
+void TSX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TSX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void TXA_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t x = LE_LBYTE16(cpu->register_X);
 
@@ -2746,6 +3226,13 @@ void TXA(struct data_bus *data_bus)
 	}
 }
 
+void TXA(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TXA_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void TXS(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2763,15 +3250,15 @@ void TXS(struct data_bus *data_bus)
 	}
 }
 
-void TXY(struct data_bus *data_bus)
+static inline void TXY_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t x = get_X(cpu);
+		uint8_t x = get_X_sized(cpu, x_size);
 
 		cpu->register_Y = SWP_LE_LBYTE16(cpu->register_Y, x);
 
@@ -2780,7 +3267,7 @@ void TXY(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t x = get_X(cpu);
+		uint16_t x = get_X_sized(cpu, x_size);
 
 		cpu->register_Y = x;
 
@@ -2789,13 +3276,20 @@ void TXY(struct data_bus *data_bus)
 	}
 }
 
-void TYA(struct data_bus *data_bus)
+void TXY(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TXY_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void TYA_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(accumulator_size(cpu) == 8)
+	if(m_size == 8)
 	{
 		uint8_t y = LE_LBYTE16(cpu->register_Y);
 
@@ -2815,15 +3309,22 @@ void TYA(struct data_bus *data_bus)
 	}
 }
 
-void TYX(struct data_bus *data_bus)
+void TYA(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TYA_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
+static inline void TYX_sized(struct data_bus *data_bus, const int m_size, const int x_size)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	add_internal_operation(data_bus);
 
-	if(index_size(cpu) == 8)
+	if(x_size == 8)
 	{
-		uint8_t y = get_Y(cpu);
+		uint8_t y = get_Y_sized(cpu, x_size);
 
 		cpu->register_X = SWP_LE_LBYTE16(cpu->register_X, y);
 
@@ -2832,7 +3333,7 @@ void TYX(struct data_bus *data_bus)
 	}
 	else 
 	{
-		uint16_t y = get_Y(cpu);
+		uint16_t y = get_Y_sized(cpu, x_size);
 
 		cpu->register_X = y;
 
@@ -2841,6 +3342,13 @@ void TYX(struct data_bus *data_bus)
 	}
 }
 
+void TYX(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	TYX_sized(data_bus, accumulator_size(cpu), index_size(cpu));
+}
+
 void WAI(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2890,20 +3398,22 @@ void XCE(struct data_bus *data_bus)
 	swap_cpu_status(cpu, cpu->cpu_status);
 }
 
-void hw_nmi(struct data_bus *data_bus)
+// pushes the return address and status, then jumps through the vector for the current mode
+static void hw_interrupt(struct data_bus *data_bus, const uint32_t *vector_6502, const uint32_t *vector_65816)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
 	cpu->RDY = 1;
 
-	// I don't know
+	// the opcode is fetched and thrown away, the return address is still this instruction
 	fetch(data_bus);
+	cpu->program_ctr--;
 	// probably getting stack_ptr
 	add_internal_operation(data_bus);
 
 	uint16_t short_addr = 0x00;
 
-	if(check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E))
+	if(!check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E))
 	{
 		push_SP(data_bus, cpu->program_bank);
 	}
@@ -2912,19 +3422,32 @@ void hw_nmi(struct data_bus *data_bus)
 	push_SP(data_bus, LE_LBYTE16(cpu->program_ctr));
 	push_SP(data_bus, cpu->cpu_status);
 
+	cpu->cpu_status |= CPU_STATUS_I;
+	cpu->cpu_status &= ~CPU_STATUS_D;
+
 	if(check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E))
 	{
-		short_addr = LE_COMBINE_2BYTE(DB_read(data_bus, NMI_VECTOR_6502[0]), DB_read(data_bus, NMI_VECTOR_6502[1]));
+		short_addr = LE_COMBINE_2BYTE(DB_read(data_bus, vector_6502[0]), DB_read(data_bus, vector_6502[1]));
 	}
 	else 
 	{
-		short_addr = LE_COMBINE_2BYTE(DB_read(data_bus, NMI_VECTOR_65816[0]), DB_read(data_bus, NMI_VECTOR_65816[1]));
+		short_addr = LE_COMBINE_2BYTE(DB_read(data_bus, vector_65816[0]), DB_read(data_bus, vector_65816[1]));
 	}
 
 	cpu->program_bank = 0x00;
 	cpu->program_ctr = short_addr;
 }
 
+void hw_nmi(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	// edge triggered, taking it is what lets the next one in
+	cpu->NMI_line = 1;
+
+	hw_interrupt(data_bus, NMI_VECTOR_6502, NMI_VECTOR_65816);
+}
+
 void hw_reset(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -2958,33 +3481,8 @@ void hw_reset(struct data_bus *data_bus)
 
 void hw_irq(struct data_bus *data_bus)
 {
-	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
-
-	cpu->RDY = 1;
-	
-	// I don't know
-	fetch(data_bus);
-	// probably getting stack_ptr
-	add_internal_operation(data_bus);
-
-	uint16_t short_addr = 0x00;
-
-	if(check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E))
-	{
-		push_SP(data_bus, cpu->program_bank);
-	}
-
-	push_SP(data_bus, LE_HBYTE16(cpu->program_ctr));
-	push_SP(data_bus, LE_LBYTE16(cpu->program_ctr));
-	push_SP(data_bus, cpu->cpu_status);
-
-	if(check_bit8(cpu->cpu_emulation6502, CPU_STATUS_E))
-	{
-		short_addr = LE_COMBINE_2BYTE(DB_read(data_bus, NMI_VECTOR_6502[0]), DB_read(data_bus, NMI_VECTOR_6502[1]));
-	}
-
-	cpu->program_bank = 0x00;
-	cpu->program_ctr = short_addr;
+	// level triggered, stays up until TIMEUP is read and is masked by I
+	hw_interrupt(data_bus, IRQ_VECTOR_6502, IRQ_VECTOR_65816);
 }
 
 uint8_t fetch(struct data_bus *data_bus)
@@ -2994,6 +3492,8 @@ uint8_t fetch(struct data_bus *data_bus)
 	uint32_t opcode_addr = LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr);
 	cpu->program_ctr++;
 
+	cpu->decoded = decode_instruction(data_bus, opcode_addr);
+
 	return DB_read(data_bus, opcode_addr);
 }
 
@@ -5280,6 +5780,341 @@ void execute(struct data_bus *data_bus, uint8_t instruction)
 	}
 }
 
+#if THREADED_CORE
+
+// Every opcode is instantiated once per accumulator/index size so the size
+// checks fold away; E forces both to 8 and so shares the M8_X8 table.
+#define SPECIALIZED_OPCODES(OPCODE) \
+	OPCODE(ADC_ABS, ADC_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(ADC_ABS_IIX, ADC_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_ABS_IIY, ADC_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_ABS_L, ADC_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(ADC_ABS_LIX, ADC_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_DIR, ADC_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(ADC_STK_R, ADC_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(ADC_DIR_IX, ADC_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_DIR_I, ADC_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(ADC_DIR_IL, ADC_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(ADC_STK_RII, ADC_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_DIR_IIX, ADC_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_DIR_IIY, ADC_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_DIR_ILI, ADC_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ADC_IMM, ADC_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_ABS, AND_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(AND_ABS_IIX, AND_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_ABS_IIY, AND_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_ABS_L, AND_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(AND_ABS_LIX, AND_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_DIR, AND_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(AND_STK_R, AND_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(AND_DIR_IX, AND_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_DIR_I, AND_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(AND_DIR_IL, AND_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(AND_STK_RII, AND_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_DIR_IIX, AND_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_DIR_IIY, AND_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_DIR_ILI, AND_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(AND_IMM, AND_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ASL_ABS, ASL_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(ASL_ACC, ASL_A_sized(data_bus, m_size, x_size)) \
+	OPCODE(ASL_ABS_IIX, ASL_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ASL_DIR, ASL_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(ASL_DIR_IX, ASL_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(BCC_REL, BCC(data_bus, addr_REL(data_bus))) \
+	OPCODE(BCS_REL, BCS(data_bus, addr_REL(data_bus))) \
+	OPCODE(BEQ_REL, BEQ(data_bus, addr_REL(data_bus))) \
+	OPCODE(BIT_ABS, BIT_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(BIT_ABS_IIX, BIT_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(BIT_DIR, BIT_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(BIT_DIR_IX, BIT_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(BIT_IMM, BIT_IMM_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(BMI_REL, BMI(data_bus, addr_REL(data_bus))) \
+	OPCODE(BNE_REL, BNE(data_bus, addr_REL(data_bus))) \
+	OPCODE(BPL_REL, BPL(data_bus, addr_REL(data_bus))) \
+	OPCODE(BRA_REL, BRA(data_bus, addr_REL(data_bus))) \
+	OPCODE(BRK_STK, BRK(data_bus)) \
+	OPCODE(BRL_REL_L, BRL(data_bus, addr_REL_L(data_bus))) \
+	OPCODE(BVC_REL, BVC(data_bus, addr_REL(data_bus))) \
+	OPCODE(BVS_REL, BVS(data_bus, addr_REL(data_bus))) \
+	OPCODE(CLC_IMP, CLC(data_bus)) \
+	OPCODE(CLD_IMP, CLD(data_bus)) \
+	OPCODE(CLI_IMP, CLI(data_bus)) \
+	OPCODE(CLV_IMP, CLV(data_bus)) \
+	OPCODE(CMP_ABS, CMP_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(CMP_ABS_IIX, CMP_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_ABS_IIY, CMP_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_ABS_L, CMP_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(CMP_ABS_LIX, CMP_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_DIR, CMP_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(CMP_STK_R, CMP_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(CMP_DIR_IX, CMP_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_DIR_I, CMP_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(CMP_DIR_IL, CMP_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(CMP_STK_RII, CMP_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_DIR_IIX, CMP_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_DIR_IIY, CMP_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_DIR_ILI, CMP_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CMP_IMM, CMP_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(COP_STK, COP(data_bus)) \
+	OPCODE(CPX_ABS, CPX_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(CPX_DIR, CPX_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(CPX_IMM, CPX_sized(data_bus, addr_IMM_X_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(CPY_ABS, CPY_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(CPY_DIR, CPY_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(CPY_IMM, CPY_sized(data_bus, addr_IMM_X_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(DEC_ABS, DEC_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(DEC_ACC, DEC_A_sized(data_bus, m_size, x_size)) \
+	OPCODE(DEC_ABS_IIX, DEC_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(DEC_DIR, DEC_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(DEC_DIR_IX, DEC_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(DEX_IMP, DEX_sized(data_bus, m_size, x_size)) \
+	OPCODE(DEY_IMP, DEY_sized(data_bus, m_size, x_size)) \
+	OPCODE(EOR_ABS, EOR_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(EOR_ABS_IIX, EOR_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_ABS_IIY, EOR_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_ABS_L, EOR_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(EOR_ABS_LIX, EOR_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_DIR, EOR_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(EOR_STK_R, EOR_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(EOR_DIR_IX, EOR_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_DIR_I, EOR_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(EOR_DIR_IL, EOR_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(EOR_STK_RII, EOR_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_DIR_IIX, EOR_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_DIR_IIY, EOR_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_DIR_ILI, EOR_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(EOR_IMM, EOR_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(INC_ABS, INC_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(INC_ACC, INC_A_sized(data_bus, m_size, x_size)) \
+	OPCODE(INC_ABS_IIX, INC_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(INC_DIR, INC_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(INC_DIR_IX, INC_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(INX_IMP, INX_sized(data_bus, m_size, x_size)) \
+	OPCODE(INY_IMP, INY_sized(data_bus, m_size, x_size)) \
+	OPCODE(JML_ABS_IL, JMP(data_bus, addr_ABS_IL(data_bus))) \
+	OPCODE(JML_ABS_L, JMP(data_bus, addr_ABS_L(data_bus))) \
+	OPCODE(JMP_ABS, JMP(data_bus, addr_ABS(data_bus))) \
+	OPCODE(JMP_ABS_I, JMP(data_bus, addr_ABS_I(data_bus))) \
+	OPCODE(JMP_ABS_II, JMP(data_bus, addr_ABS_II_sized(data_bus, m_size, x_size))) \
+	OPCODE(JSL_ABS_L, JSL(data_bus, addr_ABS_L(data_bus))) \
+	OPCODE(JSR_ABS, JSR(data_bus, addr_ABS(data_bus))) \
+	OPCODE(JSR_ABS_II, JSR(data_bus, addr_ABS_II_sized(data_bus, m_size, x_size))) \
+	OPCODE(LDA_ABS, LDA_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(LDA_ABS_IIX, LDA_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_ABS_IIY, LDA_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_ABS_L, LDA_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(LDA_ABS_LIX, LDA_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_DIR, LDA_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(LDA_STK_R, LDA_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(LDA_DIR_IX, LDA_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_DIR_I, LDA_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(LDA_DIR_IL, LDA_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(LDA_STK_RII, LDA_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_DIR_IIX, LDA_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_DIR_IIY, LDA_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_DIR_ILI, LDA_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDA_IMM, LDA_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDX_ABS, LDX_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(LDX_ABS_IIY, LDX_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDX_DIR, LDX_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(LDX_DIR_IY, LDX_sized(data_bus, addr_DIR_IY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDX_IMM, LDX_sized(data_bus, addr_IMM_X_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDY_ABS, LDY_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(LDY_ABS_IIX, LDY_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDY_DIR, LDY_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(LDY_DIR_IX, LDY_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LDY_IMM, LDY_sized(data_bus, addr_IMM_X_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LSR_ABS, LSR_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(LSR_ACC, LSR_A_sized(data_bus, m_size, x_size)) \
+	OPCODE(LSR_ABS_IIX, LSR_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(LSR_DIR, LSR_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(LSR_DIR_IX, LSR_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(MVN_XYC, MVN_sized(data_bus, addr_XYC(data_bus), m_size, x_size)) \
+	OPCODE(MVP_XYC, MVP_sized(data_bus, addr_XYC(data_bus), m_size, x_size)) \
+	OPCODE(NOP_IMP, NOP(data_bus)) \
+	OPCODE(ORA_ABS, ORA_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(ORA_ABS_IIX, ORA_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_ABS_IIY, ORA_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_ABS_L, ORA_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(ORA_ABS_LIX, ORA_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_DIR, ORA_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(ORA_STK_R, ORA_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(ORA_DIR_IX, ORA_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_DIR_I, ORA_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(ORA_DIR_IL, ORA_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(ORA_STK_RII, ORA_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_DIR_IIX, ORA_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_DIR_IIY, ORA_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_DIR_ILI, ORA_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ORA_IMM, ORA_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(PEA_STK, PEA(data_bus, addr_ABS(data_bus))) \
+	OPCODE(PEI_STK, PEI(data_bus, addr_DIR_I(data_bus))) \
+	OPCODE(PER_STK, PER(data_bus, addr_REL_L(data_bus))) \
+	OPCODE(PHA_STK, PHA_sized(data_bus, m_size, x_size)) \
+	OPCODE(PHB_STK, PHB(data_bus)) \
+	OPCODE(PHD_STK, PHD(data_bus)) \
+	OPCODE(PHK_STK, PHK(data_bus)) \
+	OPCODE(PHP_STK, PHP(data_bus)) \
+	OPCODE(PHX_STK, PHX_sized(data_bus, m_size, x_size)) \
+	OPCODE(PHY_STK, PHY_sized(data_bus, m_size, x_size)) \
+	OPCODE(PLA_STK, PLA_sized(data_bus, m_size, x_size)) \
+	OPCODE(PLB_STK, PLB(data_bus)) \
+	OPCODE(PLD_STK, PLD(data_bus)) \
+	OPCODE(PLP_STK, PLP(data_bus)) \
+	OPCODE(PLX_STK, PLX_sized(data_bus, m_size, x_size)) \
+	OPCODE(PLY_STK, PLY_sized(data_bus, m_size, x_size)) \
+	OPCODE(REP_IMM, REP(data_bus, addr_IMM_8(data_bus))) \
+	OPCODE(ROL_ABS, ROL_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(ROL_ACC, ROL_A_sized(data_bus, m_size, x_size)) \
+	OPCODE(ROL_ABS_IIX, ROL_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ROL_DIR, ROL_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(ROL_DIR_IX, ROL_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ROR_ABS, ROR_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(ROR_ACC, ROR_A_sized(data_bus, m_size, x_size)) \
+	OPCODE(ROR_ABS_IIX, ROR_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(ROR_DIR, ROR_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(ROR_DIR_IX, ROR_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(RTI_STK, RTI(data_bus)) \
+	OPCODE(RTL_STK, RTL(data_bus)) \
+	OPCODE(RTS_STK, RTS(data_bus)) \
+	OPCODE(SBC_ABS, SBC_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(SBC_ABS_IIX, SBC_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_ABS_IIY, SBC_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_ABS_L, SBC_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(SBC_ABS_LIX, SBC_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_DIR, SBC_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(SBC_STK_R, SBC_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(SBC_DIR_IX, SBC_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_DIR_I, SBC_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(SBC_DIR_IL, SBC_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(SBC_STK_RII, SBC_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_DIR_IIX, SBC_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_DIR_IIY, SBC_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_DIR_ILI, SBC_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SBC_IMM, SBC_sized(data_bus, addr_IMM_M_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(SEC_IMP, SEC(data_bus)) \
+	OPCODE(SED_IMP, SED(data_bus)) \
+	OPCODE(SEI_IMP, SEI(data_bus)) \
+	OPCODE(SEP_IMM, SEP(data_bus, addr_IMM_8(data_bus))) \
+	OPCODE(STA_ABS, STA_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(STA_ABS_IIX, STA_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_ABS_IIY, STA_sized(data_bus, addr_ABS_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_ABS_L, STA_sized(data_bus, addr_ABS_L(data_bus), m_size, x_size)) \
+	OPCODE(STA_ABS_LIX, STA_sized(data_bus, addr_ABS_LIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_DIR, STA_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(STA_STK_R, STA_sized(data_bus, addr_STK_R(data_bus), m_size, x_size)) \
+	OPCODE(STA_DIR_IX, STA_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_DIR_I, STA_sized(data_bus, addr_DIR_I(data_bus), m_size, x_size)) \
+	OPCODE(STA_DIR_IL, STA_sized(data_bus, addr_DIR_IL(data_bus), m_size, x_size)) \
+	OPCODE(STA_STK_RII, STA_sized(data_bus, addr_STK_RII_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_DIR_IIX, STA_sized(data_bus, addr_DIR_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_DIR_IIY, STA_sized(data_bus, addr_DIR_IIY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STA_DIR_ILI, STA_sized(data_bus, addr_DIR_ILI_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STP_IMP, STP(data_bus)) \
+	OPCODE(STX_ABS, STX_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(STX_DIR, STX_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(STX_DIR_IY, STX_sized(data_bus, addr_DIR_IY_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STY_ABS, STY_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(STY_DIR, STY_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(STY_DIR_IX, STY_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STZ_ABS, STZ_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(STZ_ABS_IIX, STZ_sized(data_bus, addr_ABS_IIX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(STZ_DIR, STZ_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(STZ_DIR_IX, STZ_sized(data_bus, addr_DIR_IX_sized(data_bus, m_size, x_size), m_size, x_size)) \
+	OPCODE(TAX_IMP, TAX_sized(data_bus, m_size, x_size)) \
+	OPCODE(TAY_IMP, TAY_sized(data_bus, m_size, x_size)) \
+	OPCODE(TCD_IMP, TCD(data_bus)) \
+	OPCODE(TCS_IMP, TCS(data_bus)) \
+	OPCODE(TDC_IMP, TDC(data_bus)) \
+	OPCODE(TRB_ABS, TRB_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(TRB_DIR, TRB_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(TSB_ABS, TSB_sized(data_bus, addr_ABS(data_bus), m_size, x_size)) \
+	OPCODE(TSB_DIR, TSB_sized(data_bus, addr_DIR(data_bus), m_size, x_size)) \
+	OPCODE(TSC_IMP, TSC(data_bus)) \
+	OPCODE(TSX_IMP, TSX_sized(data_bus, m_size, x_size)) \
+	OPCODE(TXA_IMP, TXA_sized(data_bus, m_size, x_size)) \
+	OPCODE(TXS_IMP, TXS(data_bus)) \
+	OPCODE(TXY_IMP, TXY_sized(data_bus, m_size, x_size)) \
+	OPCODE(TYA_IMP, TYA_sized(data_bus, m_size, x_size)) \
+	OPCODE(TYX_IMP, TYX_sized(data_bus, m_size, x_size)) \
+	OPCODE(WAI_IMP, WAI(data_bus)) \
+	OPCODE(WDM_IMM, WDM(data_bus)) \
+	OPCODE(XBA_IMP, XBA(data_bus)) \
+	OPCODE(XCE_IMP, XCE(data_bus))
+
+#define SPECIALIZE(name, ...) \
+	static inline __attribute__((always_inline)) void name##_body(struct data_bus *data_bus, const int m_size, const int x_size) \
+	{ \
+		__VA_ARGS__; \
+	} \
+	static void name##_M8_X8(struct data_bus *data_bus) { name##_body(data_bus, 8, 8); } \
+	static void name##_M8_X16(struct data_bus *data_bus) { name##_body(data_bus, 8, 16); } \
+	static void name##_M16_X8(struct data_bus *data_bus) { name##_body(data_bus, 16, 8); } \
+	static void name##_M16_X16(struct data_bus *data_bus) { name##_body(data_bus, 16, 16); }
+
+SPECIALIZED_OPCODES(SPECIALIZE)
+
+#define M8_X8_ENTRY(name, ...) [OPCODE_##name] = name##_M8_X8,
+#define M8_X16_ENTRY(name, ...) [OPCODE_##name] = name##_M8_X16,
+#define M16_X8_ENTRY(name, ...) [OPCODE_##name] = name##_M16_X8,
+#define M16_X16_ENTRY(name, ...) [OPCODE_##name] = name##_M16_X16,
+
+static const opcode_handler opcode_tables[4][256] = 
+{
+	{ SPECIALIZED_OPCODES(M8_X8_ENTRY) },
+	{ SPECIALIZED_OPCODES(M8_X16_ENTRY) },
+	{ SPECIALIZED_OPCODES(M16_X8_ENTRY) },
+	{ SPECIALIZED_OPCODES(M16_X16_ENTRY) },
+};
+
+#endif // THREADED_CORE
+
+static void select_opcode_table(struct Ricoh_5A22 *cpu)
+{
+	cpu->size_flags = 0;
+
+	if(accumulator_size(cpu) == 16)
+	{
+		cpu->size_flags |= 0b10;
+	}
+
+	if(index_size(cpu) == 16)
+	{
+		cpu->size_flags |= 0b01;
+	}
+
+#if THREADED_CORE
+	cpu->opcode_table = opcode_tables[cpu->size_flags];
+#endif
+}
+
+void dispatch(struct data_bus *data_bus, uint8_t instruction)
+{
+#if THREADED_CORE
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(cpu->decoded->handler)
+	{
+		cpu->decoded->handler(data_bus);
+	}
+	else 
+	{
+		cpu->opcode_table[instruction](data_bus);
+	}
+#else
+	execute(data_bus, instruction);
+#endif
+}
+
+void init_ricoh_5a22(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	cpu->decode_cache = malloc(DECODE_CACHE_SIZE * sizeof(struct decoded_instruction));
+
+	reset_ricoh_5a22(data_bus);
+}
+
 void reset_ricoh_5a22(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
@@ -5307,10 +6142,33 @@ void reset_ricoh_5a22(struct data_bus *data_bus)
 
 	cpu->queued_cyles = 0;
 
+	memset(&cpu->loop_head, 0, sizeof(cpu->loop_head));
+	cpu->loop_clock = 0;
+	cpu->loop_deadline = 0;
+	cpu->loop_clean = 0;
+
 	cpu->RDY = 1;
 	cpu->LPM = 0;
 
-	cpu->NMI_line = 0;
-	cpu->IRQ_line = 0;
+	cpu->REFRESH = 0;
+
+	// active low
+	cpu->NMI_line = 1;
+	cpu->IRQ_line = 1;
+
+	// the status flags are polled before the first frame sets them
+	memset(&cpu->internal_registers, 0, sizeof(cpu->internal_registers));
+
+	cpu->internal_registers.IRQEN = DISABLE;
+	cpu->internal_registers.IO_port_byte = 0xFF;
+	cpu->internal_registers.multiplication_factorA = 0xFF;
+	cpu->internal_registers.multiplication_factorB = 0xFF;
+	cpu->internal_registers.horizontal_IRQ_target = 0x01FF;
+	cpu->internal_registers.vertical_IRQ_target = 0x01FF;
+	cpu->internal_registers.cpu_version = 0x02;
+
+	cpu->internal_registers.fast_ROM = 0;
+	map_access_cycles(data_bus->A_Bus.memory, cpu->internal_registers.fast_ROM);
+	flush_decode_cache(cpu);
 }
 
@@ -1,49 +1,186 @@
 #include "cartridge.h"
 #include "memory.h"
+#include "utility.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
-void load_ROM(const char *filename, struct data_bus *data_bus)
+static int likely_first_opcode(uint8_t opcode)
 {
-	struct stat ROM_info;
-	stat(filename, &ROM_info); 
+	switch(opcode)
+	{
+		case 0x78: // SEI
+		case 0x18: // CLC
+		case 0x38: // SEC
+		case 0x9C: // STZ
+		case 0x4C: // JMP
+		case 0x5C: // JML
+		case 0xC2: // REP
+		case 0xE2: // SEP
+		case 0xA9: // LDA
+		case 0xA2: // LDX
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+// how much the bytes at header look like the internal header of a ROM_type_marker cartridge
+static int score_header(const uint8_t *ROM, uint32_t ROM_size, uint32_t header, uint8_t ROM_type_marker)
+{
+	if(header + HEADER_BYTES > ROM_size)
+	{
+		return -1;
+	}
+
+	const uint8_t *info = &ROM[header];
+	uint16_t complement = LE_COMBINE_2BYTE(info[HEADER_COMPLEMENT], info[HEADER_COMPLEMENT + 1]);
+	uint16_t checksum = LE_COMBINE_2BYTE(info[HEADER_CHECKSUM], info[HEADER_CHECKSUM + 1]);
+	uint16_t reset = LE_COMBINE_2BYTE(info[HEADER_RESET_VECTOR], info[HEADER_RESET_VECTOR + 1]);
 
-	FILE *cartridge = fopen(filename, "rb");
-	uint8_t *rom = malloc(ROM_info.st_size * sizeof(uint8_t));
-	fread(rom, ROM_info.st_size, sizeof(uint8_t), cartridge);
+	int score = 0;
 
-	int byte_height = (LoROM_ROM_BYTES[1] + 1) - LoROM_ROM_BYTES[0];
-	int banks = ROM_info.st_size / byte_height;
+	// the FastROM bit doesn't change the layout
+	if((info[HEADER_MAP_MODE] & ~0x10) == ROM_type_marker)
+	{
+		score += 2;
+	}
 
-	if(ROM_info.st_size % byte_height > 0)
+	if((uint16_t)(checksum + complement) == 0xFFFF)
 	{
-		banks++;
+		score += 4;
 	}
 
-	for(uint8_t b = 0; b < banks; b++)
+	if(info[HEADER_CARTRIDGE_TYPE] < 0x08)
 	{
-		uint32_t n_bytes = b * byte_height;
+		score++;
+	}
 
-		for(uint16_t addr = 0; addr < byte_height && n_bytes < ROM_info.st_size; addr++)
-		{
-			uint32_t A_addr = ((0x00000000 | b) << 16) | (LoROM_ROM_BYTES[0] + addr);
+	if(0x07 <= info[HEADER_ROM_SIZE] && info[HEADER_ROM_SIZE] <= 0x0D)
+	{
+		score++;
+	}
+
+	if(info[HEADER_SRAM_SIZE] <= 0x08)
+	{
+		score++;
+	}
+
+	if(info[HEADER_REGION] <= 0x14)
+	{
+		score++;
+	}
+
+	// the CPU starts in bank $00, where every layout only has ROM at $8000-$FFFF
+	if(reset < 0x8000)
+	{
+		return score - 4;
+	}
+
+	score += 2;
+
+	uint32_t entry = (header & 0x00FF0000) + (ROM_type_marker == LoROM_MARKER ? reset & 0x7FFF : reset);
+
+	if(entry < ROM_size && likely_first_opcode(ROM[entry]))
+	{
+		score += 2;
+	}
+
+	return score;
+}
+
+static uint8_t detect_ROM_type(const uint8_t *ROM, uint32_t ROM_size)
+{
+	int LoROM_score = score_header(ROM, ROM_size, LoROM_HEADER, LoROM_MARKER);
+	int HiROM_score = score_header(ROM, ROM_size, HiROM_HEADER, HiROM_MARKER);
+	int ExHiROM_score = score_header(ROM, ROM_size, ExHiROM_HEADER, ExHiROM_MARKER);
+
+	if(ExHiROM_score > LoROM_score && ExHiROM_score > HiROM_score)
+	{
+		return ExHiROM_MARKER;
+	}
+
+	if(HiROM_score > LoROM_score)
+	{
+		return HiROM_MARKER;
+	}
+
+	return LoROM_MARKER;
+}
+
+int load_ROM(const char *filename, struct Cartridge *cartridge)
+{
+	struct stat ROM_info;
+	int fd = open(filename, O_RDONLY);
 
-			ROM_write(data_bus, A_addr, rom[n_bytes]);
-			n_bytes++;
+	if(fd < 0 || fstat(fd, &ROM_info) < 0 || ROM_info.st_size <= COPIER_HEADER_BYTES)
+	{
+		printf("Failed to open ROM: %s\n", filename);
+
+		if(fd >= 0)
+		{
+			close(fd);
 		}
+
+		return 0;
+	}
+
+	cartridge->mapping_size = ROM_info.st_size;
+	cartridge->mapping = mmap(NULL, cartridge->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if(cartridge->mapping == MAP_FAILED)
+	{
+		printf("Failed to map ROM: %s\n", filename);
+
+		return 0;
+	}
+
+	// copiers put 512 bytes of their own in front of the image
+	uint32_t copier_header = (ROM_info.st_size % 1024) == COPIER_HEADER_BYTES ? COPIER_HEADER_BYTES : 0;
+
+	cartridge->ROM_size = ROM_info.st_size - copier_header;
+	cartridge->ROM = cartridge->mapping + copier_header;
+	cartridge->mapped = 1;
+
+	if(cartridge->ROM_size % PAGE_SIZE != 0)
+	{
+		// the last page would run off the end of the mapping, copy into whole pages instead
+		uint8_t *ROM = calloc((cartridge->ROM_size + PAGE_MASK) & ~PAGE_MASK, sizeof(uint8_t));
+
+		memcpy(ROM, cartridge->ROM, cartridge->ROM_size);
+		munmap(cartridge->mapping, cartridge->mapping_size);
+
+		cartridge->mapping = NULL;
+		cartridge->mapping_size = 0;
+		cartridge->ROM = ROM;
+		cartridge->mapped = 0;
+	}
+
+	cartridge->ROM_type_marker = detect_ROM_type(cartridge->ROM, cartridge->ROM_size);
+
+	return 1;
+}
+
+void unload_ROM(struct Cartridge *cartridge)
+{
+	if(cartridge->mapped)
+	{
+		munmap(cartridge->mapping, cartridge->mapping_size);
+	}
+	else 
+	{
+		free(cartridge->ROM);
 	}
 
-	// printf("TITLE: ");
-	//
-	// for(int i = 0; i < 21; i++)
-	// {
-	// 	printf("%c", mem_read(data_bus, 0x00FFC0 + i));
-	// }
-	//
-	// printf("\n");
-	//
-	// printf("SIZE: %llu\n", ROM_info.st_size);
+	cartridge->mapping = NULL;
+	cartridge->ROM = NULL;
+	cartridge->ROM_size = 0;
 }
@@ -0,0 +1,119 @@
+#include "PPU.h"
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+typedef __m256i vec16;
+
+#define VEC_LANES 16
+#define vec_load(p) _mm256_loadu_si256((const __m256i*)(p))
+#define vec_store(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define vec_set(n) _mm256_set1_epi16(n)
+#define vec_and(a, b) _mm256_and_si256(a, b)
+#define vec_andnot(a, b) _mm256_andnot_si256(a, b)
+#define vec_or(a, b) _mm256_or_si256(a, b)
+#define vec_add(a, b) _mm256_add_epi16(a, b)
+#define vec_sub(a, b) _mm256_sub_epi16(a, b)
+#define vec_min(a, b) _mm256_min_epi16(a, b)
+#define vec_max(a, b) _mm256_max_epi16(a, b)
+#define vec_cmpeq(a, b) _mm256_cmpeq_epi16(a, b)
+#define vec_srli(a, n) _mm256_srli_epi16(a, n)
+#define vec_srai(a, n) _mm256_srai_epi16(a, n)
+#define vec_slli(a, n) _mm256_slli_epi16(a, n)
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+
+typedef __m128i vec16;
+
+#define VEC_LANES 8
+#define vec_load(p) _mm_loadu_si128((const __m128i*)(p))
+#define vec_store(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define vec_set(n) _mm_set1_epi16(n)
+#define vec_and(a, b) _mm_and_si128(a, b)
+#define vec_andnot(a, b) _mm_andnot_si128(a, b)
+#define vec_or(a, b) _mm_or_si128(a, b)
+#define vec_add(a, b) _mm_add_epi16(a, b)
+#define vec_sub(a, b) _mm_sub_epi16(a, b)
+#define vec_min(a, b) _mm_min_epi16(a, b)
+#define vec_max(a, b) _mm_max_epi16(a, b)
+#define vec_cmpeq(a, b) _mm_cmpeq_epi16(a, b)
+#define vec_srli(a, n) _mm_srli_epi16(a, n)
+#define vec_srai(a, n) _mm_srai_epi16(a, n)
+#define vec_slli(a, n) _mm_slli_epi16(a, n)
+#endif
+
+static int apply_channel(int main, int sub, uint16_t flags, int subtract)
+{
+	if(flags & COLOR_MATH_ENABLE)
+	{
+		main = subtract ? main - sub : main + sub;
+
+		if(flags & COLOR_MATH_HALF)
+		{
+			main >>= 1;
+		}
+
+		main = main < 0 ? 0 : main;
+		main = main > 0x1F ? 0x1F : main;
+	}
+
+	return main;
+}
+
+static uint16_t apply_pixel(uint16_t main, uint16_t sub, uint16_t flags, int subtract)
+{
+	uint16_t r = apply_channel(main & 0x1F, sub & 0x1F, flags, subtract);
+	uint16_t g = apply_channel((main >> 5) & 0x1F, (sub >> 5) & 0x1F, flags, subtract);
+	uint16_t b = apply_channel((main >> 10) & 0x1F, (sub >> 10) & 0x1F, flags, subtract);
+
+	return r | (g << 5) | (b << 10);
+}
+
+#ifdef VEC_LANES
+static vec16 select16(vec16 mask, vec16 a, vec16 b)
+{
+	return vec_or(vec_and(mask, a), vec_andnot(mask, b));
+}
+
+static vec16 vec_channel(vec16 main, vec16 sub, vec16 enable, vec16 half, int subtract)
+{
+	vec16 math = subtract ? vec_sub(main, sub) : vec_add(main, sub);
+
+	math = select16(half, vec_srai(math, 1), math);
+	math = vec_max(vec_min(math, vec_set(0x1F)), vec_set(0));
+
+	return select16(enable, math, main);
+}
+#endif
+
+// add/subtract, halve and clamp the sub screen into the main screen
+void color_math(uint16_t *out, const uint16_t *main, const uint16_t *sub, const uint16_t *flags, int subtract, int count)
+{
+	int x = 0;
+
+#ifdef VEC_LANES
+	vec16 channel = vec_set(0x1F);
+
+	for(; x + VEC_LANES <= count; x += VEC_LANES)
+	{
+		vec16 m = vec_load(&main[x]);
+		vec16 s = vec_load(&sub[x]);
+		vec16 f = vec_load(&flags[x]);
+
+		vec16 enable = vec_cmpeq(vec_and(f, vec_set(COLOR_MATH_ENABLE)), vec_set(COLOR_MATH_ENABLE));
+		vec16 half = vec_cmpeq(vec_and(f, vec_set(COLOR_MATH_HALF)), vec_set(COLOR_MATH_HALF));
+
+		vec16 r = vec_channel(vec_and(m, channel), vec_and(s, channel), enable, half, subtract);
+		vec16 g = vec_channel(vec_and(vec_srli(m, 5), channel), vec_and(vec_srli(s, 5), channel), enable, half, subtract);
+		vec16 b = vec_channel(vec_and(vec_srli(m, 10), channel), vec_and(vec_srli(s, 10), channel), enable, half, subtract);
+
+		vec_store(&out[x], vec_or(r, vec_or(vec_slli(g, 5), vec_slli(b, 10))));
+	}
+#endif
+
+	for(; x < count; x++)
+	{
+		out[x] = apply_pixel(main[x], sub[x], flags[x], subtract);
+	}
+}
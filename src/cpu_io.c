@@ -2,110 +2,168 @@
 #include "ricoh5A22.h"
 #include "PPU.h"
 #include "registers.h"
+#include "scheduler.h"
 #include <stdint.h>
 #include <stdio.h>
 
-#define FAST_ACCESS 6
-#define MEDIUM_ACCESS 8
-#define SLOW_ACCESS 12
+static uint8_t access_cycles(struct page *page, uint32_t addr)
+{
+	if(page->access_cycles == MIXED_ACCESS)
+	{
+		if((addr & 0x0000FE00) == 0x4000)
+		{
+			return SLOW_ACCESS;
+		}
 
-uint8_t DB_read(struct data_bus *data_bus, uint32_t addr)
+		return FAST_ACCESS;
+	}
+
+	return page->access_cycles;
+}
+
+uint8_t bus_cycles(struct data_bus *data_bus, uint32_t addr)
+{
+	return access_cycles(&data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)], addr);
+}
+
+static struct decoded_instruction undecoded = { UNDECODED_KEY, 0, 0, { 0 }, { 0 }, NULL, 0, NULL };
+
+void flush_decode_cache(struct Ricoh_5A22 *cpu)
+{
+	for(int i = 0; i < DECODE_CACHE_SIZE; i++)
+	{
+		cpu->decode_cache[i].key = UNDECODED_KEY;
+	}
+
+	cpu->decoded = &undecoded;
+}
+
+struct decoded_instruction *decode_instruction(struct data_bus *data_bus, uint32_t addr)
 {
-	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct page *page = &data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)];
+	struct decoded_instruction *decoded = &cpu->decode_cache[DECODE_CACHE_INDEX(addr)];
+	uint32_t key = addr | (cpu->size_flags << 24);
 
-	if(IN_WRAM(cartridge_addr) || IN_WRAM_LOWRAM_MIRROR(cartridge_addr))
+	if(decoded->key == key && *decoded->generation == decoded->generation_value)
 	{
-		cpu->queued_cyles += MEDIUM_ACCESS;
-		sync_DMA(data_bus, MEDIUM_ACCESS);
-	} 
-	else if(IN_REG(cartridge_addr))
+		return decoded;
+	}
+
+	// registers, open bus and SRAM are fetched byte by byte
+	if(!page->generation)
 	{
-		uint32_t reg_addr = cartridge_addr - 0x800000;
+		return &undecoded;
+	}
 
-		if(0x4000 <= reg_addr && reg_addr <= 0x41FF)
-		{
-			cpu->queued_cyles += SLOW_ACCESS;
-			sync_DMA(data_bus, SLOW_ACCESS);
-		}
-		else
-		{
-			cpu->queued_cyles += FAST_ACCESS;
-			sync_DMA(data_bus, FAST_ACCESS);
-		}
+	decoded->key = key;
+	decoded->addr = addr;
+	decoded->length = DECODE_BYTES;
+
+	// operands past the end of the page belong to another generation
+	if(PAGE_SIZE - (addr & PAGE_MASK) < DECODE_BYTES)
+	{
+		decoded->length = PAGE_SIZE - (addr & PAGE_MASK);
 	}
-	if(data_bus->A_Bus.memory->ROM_type_marker == LoROM_MARKER)
+
+	for(int i = 0; i < decoded->length; i++)
 	{
-		if(IN_LoROM_ROM(cartridge_addr) || IN_LoROM_ROM_MIRROR(cartridge_addr))
-		{
-			if(cpu->internal_registers.fast_ROM && 0x80 <= addr && addr <= 0xFF)
-			{
-				cpu->queued_cyles += FAST_ACCESS;
-				sync_DMA(data_bus, FAST_ACCESS);
-			}
-			else 
-			{
-				cpu->queued_cyles += MEDIUM_ACCESS;
-				sync_DMA(data_bus, MEDIUM_ACCESS);
-			}
-		}
-		else if(IN_LoROM_SRAM(cartridge_addr) || IN_LoROM_SRAM_MIRROR(cartridge_addr))
-		{
-			cpu->queued_cyles += MEDIUM_ACCESS;
-			sync_DMA(data_bus, MEDIUM_ACCESS);
-		}
+		decoded->bytes[i] = page->ptr[(addr + i) & PAGE_MASK];
+		decoded->cycles[i] = access_cycles(page, addr + i);
 	}
 
-	return mem_read(data_bus, addr);
+	decoded->generation = page->generation;
+	decoded->generation_value = *page->generation;
+
+#if THREADED_CORE
+	decoded->handler = cpu->opcode_table[decoded->bytes[0]];
+#else
+	decoded->handler = NULL;
+#endif
+
+	return decoded;
 }
 
-void DB_write(struct data_bus *data_bus, uint32_t addr, uint8_t write_val)
+// reads an idle loop can repeat without changing anything, the status registers only change on PPU events
+static int idle_read(struct data_bus *data_bus, struct page *page, uint32_t addr)
 {
-	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(IN_WRAM(cartridge_addr) || IN_WRAM_LOWRAM_MIRROR(cartridge_addr))
+	if(page->ptr)
 	{
-		cpu->queued_cyles += MEDIUM_ACCESS;
-		sync_DMA(data_bus, MEDIUM_ACCESS);
-	} 
-	else if(IN_REG(cartridge_addr))
+		return 1;
+	}
+	else if(page->type != PAGE_REG)
 	{
-		uint32_t reg_addr = cartridge_addr - 0x800000;
+		return 0;
+	}
 
-		if(0x4000 <= reg_addr && reg_addr <= 0x41FF)
-		{
-			cpu->queued_cyles += SLOW_ACCESS;
-			sync_DMA(data_bus, SLOW_ACCESS);
-		}
-		else
-		{
-			cpu->queued_cyles += FAST_ACCESS;
-			sync_DMA(data_bus, FAST_ACCESS);
-		}
+	switch(addr & 0x0000FFFF)
+	{
+		case RDNMI:
+			return !cpu->internal_registers.NMI_flag;
+		case TIMEUP:
+			return !cpu->internal_registers.IRQ_flag && cpu->IRQ_line;
+		case HVBJOY:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+uint8_t DB_read(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct decoded_instruction *decoded = cpu->decoded;
+	uint32_t offset = addr - decoded->addr;
+
+	// instruction bytes already decoded by fetch()
+	if(offset < decoded->length && *decoded->generation == decoded->generation_value)
+	{
+		cpu->queued_cyles += decoded->cycles[offset];
+		sync_DMA(data_bus, decoded->cycles[offset]);
+
+		data_bus->open_value = decoded->bytes[offset];
+
+		return data_bus->open_value;
 	}
-	if(data_bus->A_Bus.memory->ROM_type_marker == LoROM_MARKER)
+
+	struct page *page = &data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)];
+	uint8_t cycles = access_cycles(page, addr);
+
+	if(page->type == PAGE_REG)
 	{
-		if(IN_LoROM_ROM(cartridge_addr) || IN_LoROM_ROM_MIRROR(cartridge_addr))
-		{
-			if(cpu->internal_registers.fast_ROM && 0x80 <= addr && addr <= 0xFF)
-			{
-				cpu->queued_cyles += FAST_ACCESS;
-				sync_DMA(data_bus, FAST_ACCESS);
-			}
-			else 
-			{
-				cpu->queued_cyles += MEDIUM_ACCESS;
-				sync_DMA(data_bus, MEDIUM_ACCESS);
-			}
-		}
-		else if(IN_LoROM_SRAM(cartridge_addr) || IN_LoROM_SRAM_MIRROR(cartridge_addr))
-		{
-			cpu->queued_cyles += MEDIUM_ACCESS;
-			sync_DMA(data_bus, MEDIUM_ACCESS);
-		}
+		sync_PPU(data_bus, current_master_cycle(data_bus));
+	}
+
+	if(cpu->loop_clean && !idle_read(data_bus, page, addr))
+	{
+		cpu->loop_clean = 0;
+	}
+
+	cpu->queued_cyles += cycles;
+	sync_DMA(data_bus, cycles);
+
+	return read_page(data_bus, page, addr);
+}
+
+void DB_write(struct data_bus *data_bus, uint32_t addr, uint8_t write_val)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct page *page = &data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)];
+	uint8_t cycles = access_cycles(page, addr);
+
+	cpu->loop_clean = 0;
+
+	if(page->type == PAGE_REG)
+	{
+		sync_PPU(data_bus, current_master_cycle(data_bus));
+	}
+
+	cpu->queued_cyles += cycles;
+	sync_DMA(data_bus, cycles);
 
-	}	mem_write(data_bus, addr, write_val);
+	write_page(data_bus, page, addr, write_val);
 }
 
 void signal_vblank(struct data_bus *data_bus)
@@ -114,6 +172,11 @@ void signal_vblank(struct data_bus *data_bus)
 
 	cpu->internal_registers.NMI_flag = 1;
 	cpu->internal_registers.Vblank_flag = 1;
+
+	if(cpu->internal_registers.NMIEN)
+	{
+		cpu->NMI_line = 0;
+	}
 }
 
 void clear_vblank(struct data_bus *data_bus)
@@ -138,34 +201,13 @@ void clear_hblank(struct data_bus *data_bus)
 	cpu->internal_registers.Hblank_flag = 0;
 }
 
-void check_IRQ(struct data_bus *data_bus)
+// the H/V timer matched, the scheduler works out when it does next
+void signal_IRQ(struct data_bus *data_bus)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
-	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(cpu->internal_registers.IRQEN == ENABLEHTIME)
-	{
-		if(ppu->x == cpu->internal_registers.horizontal_IRQ_target)
-		{
-			cpu->internal_registers.IRQ_flag = 1;
-		}
-	}
-
-	if(cpu->internal_registers.IRQEN == ENABLEVTIME)
-	{
-		if(ppu->y == cpu->internal_registers.vertical_IRQ_target && ppu->x == 0)
-		{
-			cpu->internal_registers.IRQ_flag = 1;
-		}
-	}
-
-	if(data_bus->A_Bus.cpu->internal_registers.IRQEN == ENABLEHVTIME)
-	{
-		if(ppu->y == cpu->internal_registers.vertical_IRQ_target && ppu->x == cpu->internal_registers.horizontal_IRQ_target)
-		{
-			cpu->internal_registers.IRQ_flag = 1;
-		}
-	}
+	cpu->internal_registers.IRQ_flag = 1;
+	cpu->IRQ_line = 0;
 }
 
 void set_refresh(struct data_bus *data_bus)
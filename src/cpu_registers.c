@@ -4,6 +4,7 @@
 #include "ricoh5A22.h"
 #include "PPU.h"
 #include "registers.h"
+#include "scheduler.h"
 
 #define LE_HBYTE16(u16) (uint8_t)((u16 & 0xFF00) >> 8)
 #define LE_LBYTE16(u16) (uint8_t)(u16 & 0x00FF)
@@ -24,110 +25,159 @@ static uint8_t check_bit8(uint8_t ps, uint8_t mask)
 
 #define CPU_VERSION 0x02;
 
-void write_cpu_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+static void write_NMITIEN(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(addr == NMITIEN)
+	// enabling NMI inside V-blank raises it straight away
+	if(!cpu->internal_registers.NMIEN && check_bit8(write_value, 0x80) && cpu->internal_registers.NMI_flag)
 	{
-		cpu->internal_registers.NMIEN = check_bit8(write_value, 0x80);
-
-		switch ((write_value & 0b00110000) >> 4) 
-		{
-			case 0b00:
-				cpu->internal_registers.IRQEN = DISABLE;
-
-				break;
-			case 0b01:
-				cpu->internal_registers.IRQEN = ENABLEHTIME;
-				
-				break;
-			case 0b10:
-				cpu->internal_registers.IRQEN = ENABLEVTIME;
-
-				break;
-			case 0b11:
-				cpu->internal_registers.IRQEN = ENABLEHVTIME;
-				
-				break;
-		}
-
-		cpu->internal_registers.joypad_autoread = check_bit8(write_value, 0x01);
+		cpu->NMI_line = 0;
 	}
 
-	if(addr == WRIO)
-	{
-		cpu->internal_registers.IO_port_byte = write_value;
-
-		if(!check_bit8(write_value, 0x80))
-		{
-			latch_HVCT(data_bus);
-		}
-	}
+	cpu->internal_registers.NMIEN = check_bit8(write_value, 0x80);
 
-	if(addr == HTIMEL)
+	switch ((write_value & 0b00110000) >> 4) 
 	{
-		cpu->internal_registers.horizontal_IRQ_target = SWP_LE_LBYTE16(cpu->internal_registers.horizontal_IRQ_target, write_value);
+		case 0b00:
+			cpu->internal_registers.IRQEN = DISABLE;
+
+			break;
+		case 0b01:
+			cpu->internal_registers.IRQEN = ENABLEHTIME;
+			
+			break;
+		case 0b10:
+			cpu->internal_registers.IRQEN = ENABLEVTIME;
+
+			break;
+		case 0b11:
+			cpu->internal_registers.IRQEN = ENABLEHVTIME;
+			
+			break;
 	}
 
-	if(addr == HTIMEH)
-	{
-		cpu->internal_registers.horizontal_IRQ_target = SWP_LE_HBYTE16(cpu->internal_registers.horizontal_IRQ_target, write_value);
-	}
+	cpu->internal_registers.joypad_autoread = check_bit8(write_value, 0x01);
 
-	if(addr == VTIMEL)
-	{
-		cpu->internal_registers.vertical_IRQ_target = SWP_LE_LBYTE16(cpu->internal_registers.vertical_IRQ_target, write_value);
-	}
+	cpu->IRQ_line = !(cpu->internal_registers.IRQEN != DISABLE && cpu->internal_registers.IRQ_flag);
+	schedule_IRQ(data_bus);
+}
 
-	if(addr == VTIMEH)
+static void write_WRIO(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	cpu->internal_registers.IO_port_byte = write_value;
+
+	if(!check_bit8(write_value, 0x80))
 	{
-		cpu->internal_registers.vertical_IRQ_target= SWP_LE_HBYTE16(cpu->internal_registers.vertical_IRQ_target, write_value);
+		latch_HVCT(data_bus);
 	}
+}
+
+static void write_HTIMEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	cpu->internal_registers.horizontal_IRQ_target = SWP_LE_LBYTE16(cpu->internal_registers.horizontal_IRQ_target, write_value);
+
+	schedule_IRQ(data_bus);
+}
+
+static void write_HTIMEH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	cpu->internal_registers.horizontal_IRQ_target = SWP_LE_HBYTE16(cpu->internal_registers.horizontal_IRQ_target, write_value);
+
+	schedule_IRQ(data_bus);
+}
+
+static void write_VTIMEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	cpu->internal_registers.vertical_IRQ_target = SWP_LE_LBYTE16(cpu->internal_registers.vertical_IRQ_target, write_value);
+
+	schedule_IRQ(data_bus);
+}
 
-	if(addr == MEMSEL)
+static void write_VTIMEH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	cpu->internal_registers.vertical_IRQ_target= SWP_LE_HBYTE16(cpu->internal_registers.vertical_IRQ_target, write_value);
+
+	schedule_IRQ(data_bus);
+}
+
+static void write_MEMSEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(cpu->internal_registers.fast_ROM != check_bit8(write_value, 0x01))
 	{
 		cpu->internal_registers.fast_ROM = check_bit8(write_value, 0x01);
+
+		map_access_cycles(data_bus->A_Bus.memory, cpu->internal_registers.fast_ROM);
+		flush_decode_cache(cpu);
 	}
 }
 
-void read_cpu_register(struct data_bus *data_bus, uint32_t addr)
+static uint8_t read_RDNMI(struct data_bus *data_bus, uint32_t addr)
 {
 	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(addr == RDNMI)
-	{
-		uint8_t return_byte = (uint8_t)cpu->internal_registers.NMI_flag << 7;
-		return_byte |= cpu->internal_registers.interal_read_bus & 0b01110000;
-		return_byte |= cpu->internal_registers.cpu_version;
+	uint8_t return_byte = (uint8_t)cpu->internal_registers.NMI_flag << 7;
+	return_byte |= cpu->internal_registers.interal_read_bus & 0b01110000;
+	return_byte |= cpu->internal_registers.cpu_version;
 
-		write_register_raw(data_bus, addr, return_byte);
+	cpu->internal_registers.NMI_flag = 0;
 
-		cpu->internal_registers.NMI_flag = 0;
-	}
+	return return_byte;
+}
 
-	if(addr == TIMEUP)
-	{
-		uint8_t return_byte = (uint8_t)cpu->internal_registers.IRQ_flag << 7;
-		return_byte |= cpu->internal_registers.interal_read_bus & 0x7F;
+static uint8_t read_TIMEUP(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-		write_register_raw(data_bus, addr, return_byte);
+	uint8_t return_byte = (uint8_t)cpu->internal_registers.IRQ_flag << 7;
+	return_byte |= cpu->internal_registers.interal_read_bus & 0x7F;
 
-		cpu->internal_registers.IRQ_flag = 0;
-	}
+	cpu->internal_registers.IRQ_flag = 0;
+	cpu->IRQ_line = 1;
 
-	if(addr == HVBJOY)
-	{
-		uint8_t return_byte = cpu->internal_registers.Vblank_flag << 7;
-		return_byte |= cpu->internal_registers.Hblank_flag << 6;
-		return_byte |= cpu->internal_registers.joypad_autoread_flag;
+	return return_byte;
+}
 
-		write_register_raw(data_bus, addr, return_byte);
-	}
+static uint8_t read_HVBJOY(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
 
-	if(addr == RDIO)
-	{
-		write_register_raw(data_bus, addr, cpu->internal_registers.IO_port_byte);
-	}
+	uint8_t return_byte = cpu->internal_registers.Vblank_flag << 7;
+	return_byte |= cpu->internal_registers.Hblank_flag << 6;
+	return_byte |= cpu->internal_registers.joypad_autoread_flag;
+
+	return return_byte;
 }
 
+static uint8_t read_RDIO(struct data_bus *data_bus, uint32_t addr)
+{
+	return data_bus->A_Bus.cpu->internal_registers.IO_port_byte;
+}
+
+void map_cpu_registers(struct Memory *memory)
+{
+	map_register(memory, NMITIEN, NULL, write_NMITIEN);
+	map_register(memory, WRIO, NULL, write_WRIO);
+	map_register(memory, HTIMEL, NULL, write_HTIMEL);
+	map_register(memory, HTIMEH, NULL, write_HTIMEH);
+	map_register(memory, VTIMEL, NULL, write_VTIMEL);
+	map_register(memory, VTIMEH, NULL, write_VTIMEH);
+	map_register(memory, MEMSEL, NULL, write_MEMSEL);
+
+	map_register(memory, RDNMI, read_RDNMI, NULL);
+	map_register(memory, TIMEUP, read_TIMEUP, NULL);
+	map_register(memory, HVBJOY, read_HVBJOY, NULL);
+	map_register(memory, RDIO, read_RDIO, NULL);
+}
@@ -3,16 +3,6 @@
 #include "ricoh5A22.h"
 #include "PPU.h"
 
-void allow_HDMA(struct data_bus *data_bus)
-{
-	data_bus->B_bus.dma->HDMA_allowed = 1;
-}
-
-void disallow_HDMA(struct data_bus *data_bus)
-{
-	data_bus->B_bus.dma->HDMA_allowed = 0;
-}
-
 void sync_DMA(struct data_bus *data_bus, int cycles)
 {
 	if(data_bus->B_bus.dma->dma_active == 1)
@@ -22,240 +22,275 @@ static uint8_t check_bit8(uint8_t ps, uint8_t mask)
 	return 0x00;
 }
 
-void read_dma_register(struct data_bus *data_bus, uint32_t addr)
+static uint8_t read_DMAPx(struct data_bus *data_bus, uint32_t addr)
 {
-	struct DMA *dma = data_bus->B_bus.dma;
+	return data_bus->B_bus.dma->param_byte[get_channel(addr)];
+}
 
-	if(in_DMA_addr(addr, DMAPx))
-	{
-		write_register_raw(data_bus, addr, dma->param_byte[get_channel(addr)]);
-	}
+static uint8_t read_BBADx(struct data_bus *data_bus, uint32_t addr)
+{
+	return data_bus->B_bus.dma->DMA_B_addr[get_channel(addr)];
+}
 
-	if(in_DMA_addr(addr, BBADx))
-	{
-		write_register_raw(data_bus, addr, dma->DMA_B_addr[get_channel(addr)]);
-	}
+static uint8_t read_A1Tx(struct data_bus *data_bus, uint32_t addr)
+{
+	uint32_t source_addr = data_bus->B_bus.dma->DMA_source_addr[get_channel(addr)];
 
-	if(in_DMA_addr(addr, A1TxL))
+	switch(addr & 0x0000000F)
 	{
-		write_register_raw(data_bus, addr, LE_LBYTE24(dma->DMA_source_addr[get_channel(addr)]));
+		case A1TxL & 0x0F:
+			return LE_LBYTE24(source_addr);
+		case A1TxH & 0x0F:
+			return LE_HBYTE24(source_addr);
+		default:
+			return LE_BBYTE24(source_addr);
 	}
+}
 
-	if(in_DMA_addr(addr, A1TxH))
-	{
-		write_register_raw(data_bus, addr, LE_HBYTE24(dma->DMA_source_addr[get_channel(addr)]));
-	}
+static uint8_t read_DASx(struct data_bus *data_bus, uint32_t addr)
+{
+	uint32_t size_or_indirect = data_bus->B_bus.dma->DMA_size_or_indirect[get_channel(addr)];
 
-	if(in_DMA_addr(addr, A1Bx))
+	switch(addr & 0x0000000F)
 	{
-		write_register_raw(data_bus, addr, LE_BBYTE24(dma->DMA_source_addr[get_channel(addr)]));
+		case DASxL & 0x0F:
+			return LE_LBYTE24(size_or_indirect);
+		case DASxH & 0x0F:
+			return LE_HBYTE24(size_or_indirect);
+		default:
+			return LE_BBYTE24(size_or_indirect);
 	}
+}
 
-	if(in_DMA_addr(addr, DASxL))
-	{
-		write_register_raw(data_bus, addr, LE_LBYTE24(dma->DMA_size_or_indirect[get_channel(addr)]));
-	}
+static uint8_t read_A2Ax(struct data_bus *data_bus, uint32_t addr)
+{
+	uint16_t table_index = data_bus->B_bus.dma->HDMA_A_table_index[get_channel(addr)];
 
-	if(in_DMA_addr(addr, DASxH))
+	if(in_DMA_addr(addr, A2AxL))
 	{
-		write_register_raw(data_bus, addr, LE_HBYTE24(dma->DMA_size_or_indirect[get_channel(addr)]));
+		return LE_LBYTE16(table_index);
 	}
 
-	if(in_DMA_addr(addr, DASBx))
-	{
-		write_register_raw(data_bus, addr, LE_BBYTE24(dma->DMA_size_or_indirect[get_channel(addr)]));
-	}
+	return LE_HBYTE16(table_index);
+}
 
-	if(in_DMA_addr(addr, A2AxL))
-	{
-		write_register_raw(data_bus, addr, LE_LBYTE16(dma->HDMA_indirect[get_channel(addr)]));
-	}
+static uint8_t read_NLTRx(struct data_bus *data_bus, uint32_t addr)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(in_DMA_addr(addr, A2AxH))
+	uint8_t read = dma->HDMA_repeat[get_channel(addr)] << 7;
+	read |= dma->HDMA_scanline_counter[get_channel(addr)] & 0b01111111;
+
+	return read;
+}
+
+static void write_MDMAEN(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
+
+	dma->MDMA_enable[7] = check_bit8(write_value, 0x80);
+	dma->MDMA_enable[6] = check_bit8(write_value, 0x40);
+	dma->MDMA_enable[5] = check_bit8(write_value, 0x20);
+	dma->MDMA_enable[4] = check_bit8(write_value, 0x10);
+	dma->MDMA_enable[3] = check_bit8(write_value, 0x08);
+	dma->MDMA_enable[2] = check_bit8(write_value, 0x04);
+	dma->MDMA_enable[1] = check_bit8(write_value, 0x02);
+	dma->MDMA_enable[0] = check_bit8(write_value, 0x01);
+
+	if(write_value != 0x00)
 	{
-		write_register_raw(data_bus, addr, LE_HBYTE16(dma->HDMA_indirect[get_channel(addr)]));
+		dma->new_MDMA_transfer = 1;
 	}
+}
 
-	if(in_DMA_addr(addr, NLTRx))
-	{
-		uint8_t read = dma->HDMA_repeat[get_channel(addr)] << 7;
-		read |= dma->HDMA_scanline_counter[get_channel(addr)] & 0b01111111;
+static void write_HDMAEN(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-		write_register_raw(data_bus, addr, read);
-	}
+	dma->HDMA_enable[7] = check_bit8(write_value, 0x80);
+	dma->HDMA_enable[6] = check_bit8(write_value, 0x40);
+	dma->HDMA_enable[5] = check_bit8(write_value, 0x20);
+	dma->HDMA_enable[4] = check_bit8(write_value, 0x10);
+	dma->HDMA_enable[3] = check_bit8(write_value, 0x08);
+	dma->HDMA_enable[2] = check_bit8(write_value, 0x04);
+	dma->HDMA_enable[1] = check_bit8(write_value, 0x02);
+	dma->HDMA_enable[0] = check_bit8(write_value, 0x01);
 }
 
-void write_dma_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+static void write_DMAPx(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
 {
 	struct DMA *dma = data_bus->B_bus.dma;
+	int channel = get_channel(addr);
 
-	if(addr == MDMAEN)
-	{
-		dma->MDMA_enable[7] = check_bit8(write_value, 0x80);
-		dma->MDMA_enable[6] = check_bit8(write_value, 0x40);
-		dma->MDMA_enable[5] = check_bit8(write_value, 0x20);
-		dma->MDMA_enable[4] = check_bit8(write_value, 0x10);
-		dma->MDMA_enable[3] = check_bit8(write_value, 0x08);
-		dma->MDMA_enable[2] = check_bit8(write_value, 0x04);
-		dma->MDMA_enable[1] = check_bit8(write_value, 0x02);
-		dma->MDMA_enable[0] = check_bit8(write_value, 0x01);
-
-		if(write_value != 0x00)
-		{
-			dma->new_MDMA_transfer = 1;
-		}
-	}
+	dma->param_byte[channel] = write_value;
 
-	if(addr == HDMAEN)
+	switch (write_value & 0b00000111) 
 	{
-		dma->HDMA_enable[7] = check_bit8(write_value, 0x80);
-		dma->HDMA_enable[6] = check_bit8(write_value, 0x40);
-		dma->HDMA_enable[5] = check_bit8(write_value, 0x20);
-		dma->HDMA_enable[4] = check_bit8(write_value, 0x10);
-		dma->HDMA_enable[3] = check_bit8(write_value, 0x08);
-		dma->HDMA_enable[2] = check_bit8(write_value, 0x04);
-		dma->HDMA_enable[1] = check_bit8(write_value, 0x02);
-		dma->HDMA_enable[0] = check_bit8(write_value, 0x01);
-
-		if(write_value != 0x00)
-		{
-			memset(dma->HDMA_channels_finished, 0, 8);
-		}
+		case 0:
+			dma->transfer_pattern[channel] = P0; 
+
+			break;
+		case 1:
+			dma->transfer_pattern[channel] = P1; 
+
+			break;
+		case 2:
+			dma->transfer_pattern[channel] = P2; 
+
+			break;
+		case 3:
+			dma->transfer_pattern[channel] = P3; 
+
+			break;
+		case 4:
+			dma->transfer_pattern[channel] = P4; 
+
+			break;
+		case 5:
+			dma->transfer_pattern[channel] = P5; 
+
+			break;
+		case 6:
+			dma->transfer_pattern[channel] = P6; 
+
+			break;
+		case 7:
+			dma->transfer_pattern[channel] = P7; 
+
+			break;
 	}
 
-	if(in_DMA_addr(addr, DMAPx))
+	switch((write_value & 0b00011000) >> 3)
 	{
-		dma->param_byte[get_channel(addr)] = write_value;
+		case 0:
+			dma->MDMA_address_adjust[channel] = Increment_A;
 
-		switch (write_value & 0x00000111) 
-		{
-			case 0:
-				dma->transfer_pattern[get_channel(addr)] = P0; 
+			break;
+		case 1:
+			dma->MDMA_address_adjust[channel] = Fixed;
 
-				break;
-			case 1:
-				dma->transfer_pattern[get_channel(addr)] = P1; 
+			break;
+		case 2:
+			dma->MDMA_address_adjust[channel] = Decrement_A;
 
-				break;
-			case 2:
-				dma->transfer_pattern[get_channel(addr)] = P2; 
+			break;
+		case 3:
+			dma->MDMA_address_adjust[channel] = Fixed;
 
-				break;
-			case 3:
-				dma->transfer_pattern[get_channel(addr)] = P3; 
+			break;
+	}
 
-				break;
-			case 4:
-				dma->transfer_pattern[get_channel(addr)] = P4; 
+	dma->HDMA_indirect[channel] = check_bit8(write_value, 0x40);
 
-				break;
-			case 5:
-				dma->transfer_pattern[get_channel(addr)] = P5; 
+	switch ((write_value & 0b10000000) >> 7) 
+	{
+		case 0: 
+			dma->direction[channel] = A_to_B;
 
-				break;
-			case 6:
-				dma->transfer_pattern[get_channel(addr)] = P6; 
+			break;
+		case 1: 
+			dma->direction[channel] = B_to_A;
 
-				break;
-			case 7:
-				dma->transfer_pattern[get_channel(addr)] = P7; 
+			break;
+	}
+}
 
-				break;
-		}
+static void write_BBADx(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	data_bus->B_bus.dma->DMA_B_addr[get_channel(addr)] = write_value;
+}
 
-		switch((write_value & 0b00011000) >> 3)
-		{
-			case 0:
-				dma->MDMA_address_adjust[get_channel(addr)] = Increment_A;
+static void write_A1TxL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-				break;
-			case 1:
-				dma->MDMA_address_adjust[get_channel(addr)] = Fixed;
+	dma->DMA_source_addr[get_channel(addr)] &= 0xFFFFFF00;
+	dma->DMA_source_addr[get_channel(addr)] |= write_value;
+}
 
-				break;
-			case 2:
-				dma->MDMA_address_adjust[get_channel(addr)] = Decrement_A;
+static void write_A1TxH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-				break;
-			case 3:
-				dma->MDMA_address_adjust[get_channel(addr)] = Fixed;
+	dma->DMA_source_addr[get_channel(addr)] &= 0xFFFF00FF;
+	dma->DMA_source_addr[get_channel(addr)] |= (0x00000000 | write_value) << 8;
+}
 
-				break;
-		}
+static void write_A1Bx(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-		dma->HDMA_indirect[get_channel(addr)] = check_bit8(write_value, 0x20);
+	dma->DMA_source_addr[get_channel(addr)] &= 0xFF00FFFF;
+	dma->DMA_source_addr[get_channel(addr)] |= (0x00000000 | write_value) << 16;
+}
 
-		switch ((write_value & 0b11000000) >> 6) 
-		{
-			case 0: 
-				dma->direction[get_channel(addr)] = A_to_B;
+static void write_DASxL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-				break;
-			case 1: 
-				dma->direction[get_channel(addr)] = B_to_A;
+	// 0 = 65536 bytes
+	dma->DMA_size_or_indirect[get_channel(addr)] &= 0xFFFFFF00;
+	dma->DMA_size_or_indirect[get_channel(addr)] |= write_value;
+}
 
-				break;
-		}
-	}
+static void write_DASxH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(in_DMA_addr(addr, BBADx))
-	{
-		dma->DMA_B_addr[get_channel(addr)] = write_value;
-	}
+	// 0 = 65536 bytes
+	dma->DMA_size_or_indirect[get_channel(addr)] &= 0xFFFF00FF;
+	dma->DMA_size_or_indirect[get_channel(addr)] |= write_value << 8;
+}
 
-	if(in_DMA_addr(addr, A1TxL))
-	{
-		dma->DMA_source_addr[get_channel(addr)] &= 0xFFFFFF00;
-		dma->DMA_source_addr[get_channel(addr)] |= write_value;
-	}
+static void write_DASBx(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(in_DMA_addr(addr, A1TxH))
-	{
-		dma->DMA_source_addr[get_channel(addr)] &= 0xFFFF00FF;
-		dma->DMA_source_addr[get_channel(addr)] |= (0x00000000 | write_value) << 8;
-	}
+	dma->DMA_size_or_indirect[get_channel(addr)] &= 0xFF00FFFF;
+	dma->DMA_size_or_indirect[get_channel(addr)] |= write_value << 16;
+}
 
-	if(in_DMA_addr(addr, A1Bx))
-	{
-		dma->DMA_source_addr[get_channel(addr)] &= 0xFF00FFFF;
-		dma->DMA_source_addr[get_channel(addr)] |= (0x00000000 | write_value) << 16;
-	}
+static void write_A2AxL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(in_DMA_addr(addr, DASxL))
-	{
-		// 0 = 65536 bytes
-		dma->DMA_size_or_indirect[get_channel(addr)] &= 0xFFFFFF00;
-		dma->DMA_size_or_indirect[get_channel(addr)] |= write_value;
-	}
+	dma->HDMA_A_table_index[get_channel(addr)] &= 0xFF00;
+	dma->HDMA_A_table_index[get_channel(addr)] |= write_value;
+}
 
-	if(in_DMA_addr(addr, DASxH))
-	{
-		// 0 = 65536 bytes
-		dma->DMA_size_or_indirect[get_channel(addr)] &= 0xFFFF00FF;
-		dma->DMA_size_or_indirect[get_channel(addr)] |= write_value << 8;
-	}
+static void write_A2AxH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(in_DMA_addr(addr, DASBx))
-	{
-		dma->DMA_size_or_indirect[get_channel(addr)] &= 0xFF00FFFF;
-		dma->DMA_size_or_indirect[get_channel(addr)] |= write_value << 16;
-	}
+	dma->HDMA_A_table_index[get_channel(addr)] &= 0x00FF;
+	dma->HDMA_A_table_index[get_channel(addr)] |= (0x0000 | write_value) << 8;
+}
 
-	if(in_DMA_addr(addr, A2AxL))
-	{
-		dma->HDMA_A_table_index[get_channel(addr)] &= 0xFF00;
-		dma->HDMA_A_table_index[get_channel(addr)] |= write_value;
-	}
+static void write_NLTRx(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct DMA *dma = data_bus->B_bus.dma;
 
-	if(in_DMA_addr(addr, A2AxH))
-	{
-		dma->HDMA_A_table_index[get_channel(addr)] &= 0x00FF;
-		dma->HDMA_A_table_index[get_channel(addr)] |= (0x0000 | write_value) << 8;
-	}
+	dma->HDMA_repeat[get_channel(addr)] = check_bit8(write_value, 0x80);
+	dma->HDMA_scanline_counter[get_channel(addr)] = write_value & 0b01111111;
+}
+
+void map_dma_registers(struct Memory *memory)
+{
+	map_register(memory, MDMAEN, NULL, write_MDMAEN);
+	map_register(memory, HDMAEN, NULL, write_HDMAEN);
 
-	if(in_DMA_addr(addr, NLTRx))
+	for(int n = 0; n < N_CHANNELS; n++)
 	{
-		dma->HDMA_repeat[get_channel(addr)] = check_bit8(write_value, 0x80);
-		dma->HDMA_scanline_counter[get_channel(addr)] = write_value * 0b011111111;
+		map_register(memory, swap_channels(DMAPx, n), read_DMAPx, write_DMAPx);
+		map_register(memory, swap_channels(BBADx, n), read_BBADx, write_BBADx);
+		map_register(memory, swap_channels(A1TxL, n), read_A1Tx, write_A1TxL);
+		map_register(memory, swap_channels(A1TxH, n), read_A1Tx, write_A1TxH);
+		map_register(memory, swap_channels(A1Bx, n), read_A1Tx, write_A1Bx);
+		map_register(memory, swap_channels(DASxL, n), read_DASx, write_DASxL);
+		map_register(memory, swap_channels(DASxH, n), read_DASx, write_DASxH);
+		map_register(memory, swap_channels(DASBx, n), read_DASx, write_DASBx);
+		map_register(memory, swap_channels(A2AxL, n), read_A2Ax, write_A2AxL);
+		map_register(memory, swap_channels(A2AxH, n), read_A2Ax, write_A2AxH);
+		map_register(memory, swap_channels(NLTRx, n), read_NLTRx, write_NLTRx);
 	}
 }
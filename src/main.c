@@ -13,18 +13,42 @@
 #include "PPU.h"
 #include "DMA.h"
 #include "cartridge.h"
+#include "scheduler.h"
+#include "savestate.h"
+#include "trace.h"
 
 #define SDL_FLAGS SDL_INIT_VIDEO
 
 #define WINDOW_TITLE "snooze"
-#define WINDOW_WIDTH DOTS
-#define WINDOW_HEIGHT LINES
+#define WINDOW_WIDTH FRAME_MAX_WIDTH
+#define WINDOW_HEIGHT (FRAME_LINES * 2)
+
+#define NTSC_FRAME_NS 16639267 // 1364 * 262 master cycles at 21.477 MHz
+#define PAL_FRAME_NS 19997194 // 1364 * 312 master cycles at 21.281 MHz
+
+// batch runs with no window, the frame buffer is still rendered unless render is 0
+struct Headless
+{
+	int enabled;
+	int frames;
+	int render;
+
+	int expect; // stop as soon as a frame hashes to expected_hash, fail if none does
+	uint64_t expected_hash;
+};
 
 struct Screen 
 {
 	SDL_Window *window;
+	SDL_Renderer *renderer;
+	SDL_Texture *texture;
 	SDL_Event event;
 	int running;
+
+	int turbo; // don't pace frames
+	uint64_t next_frame_ns;
+
+	char *state_path; // F5 saves here, F9 loads it back
 };
 
 int screen_init_SDL(struct Screen *screen)
@@ -45,11 +69,46 @@ int screen_init_SDL(struct Screen *screen)
 		return 0;
 	}
 
+	screen->renderer = SDL_CreateRenderer(screen->window, NULL);
+
+	if(!screen->renderer)
+	{
+		fprintf(stderr, "ERROR creating SDL3 renderer: %s\n", SDL_GetError());
+
+		return 0;
+	}
+
+	// the PPU's frame buffer is uploaded as is, only the top left frame_width x frame_height is shown
+	screen->texture = SDL_CreateTexture(screen->renderer, HOST_PIXEL_FORMAT, SDL_TEXTUREACCESS_STREAMING, FRAME_MAX_WIDTH, FRAME_MAX_HEIGHT);
+
+	if(!screen->texture)
+	{
+		fprintf(stderr, "ERROR creating SDL3 texture: %s\n", SDL_GetError());
+
+		return 0;
+	}
+
+	SDL_SetTextureScaleMode(screen->texture, SDL_SCALEMODE_NEAREST);
+
 	return 1;
 }
 
 void free_screen(struct Screen *screen)
 {
+	if(screen->texture)
+	{
+		SDL_DestroyTexture(screen->texture);
+
+		screen->texture = NULL;
+	}
+
+	if(screen->renderer)
+	{
+		SDL_DestroyRenderer(screen->renderer);
+
+		screen->renderer = NULL;
+	}
+
 	if(screen->window)
 	{
 		SDL_DestroyWindow(screen->window);
@@ -59,133 +118,158 @@ void free_screen(struct Screen *screen)
 
 	SDL_Quit();
 }
-enum LoopState
+void poll_events(struct Screen *screen, struct data_bus *data_bus)
 {
-	Empty,
-	Fetched,
-};
-
-void run_snooze_cycle(struct data_bus *data_bus, SDL_Surface *frame_buffer, enum LoopState *loop_state, uint8_t *instruction)
-{
-	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
-	struct S_PPU *s_ppu = data_bus->B_bus.ppu;
-	struct DMA *dma = data_bus->B_bus.dma;
-
-	cpu->NMI_line = !(cpu->internal_registers.NMIEN & cpu->internal_registers.NMI_flag);
-	cpu->IRQ_line = !((cpu->internal_registers.IRQEN != DISABLE) & cpu->internal_registers.IRQ_flag) || check_bit8(cpu->cpu_status, CPU_STATUS_I);
-
-	if(cpu->queued_cyles == 0 && !dma->dma_active)
+	while(SDL_PollEvent(&screen->event))
 	{
-		if(*loop_state == Empty)
+		switch (screen->event.type) 
 		{
-			*instruction = fetch(data_bus);
-			*loop_state = Fetched;
-		}
-		else if(*loop_state == Fetched)
-		{
-			execute(data_bus, *instruction);
-			*loop_state = Empty;
-		}
+			case SDL_EVENT_QUIT:
+				screen->running = 0;
 
-		if(cpu->REFRESH)
-		{
-			cpu->queued_cyles += 40;
-
-			cpu->REFRESH = 0;
+				break;
+			case SDL_EVENT_KEY_DOWN:
+				if(screen->event.key.repeat || !screen->state_path)
+				{
+					break;
+				}
+
+				if(screen->event.key.scancode == SDL_SCANCODE_F5)
+				{
+					save_state_file(data_bus, screen->state_path);
+				}
+				else if(screen->event.key.scancode == SDL_SCANCODE_F9)
+				{
+					load_state_file(data_bus, screen->state_path);
+				}
+
+				break;
+			default:
+				break;
 		}
 	}
+}
+
+void pace_frame(struct Screen *screen, int frame_rate)
+{
+	uint64_t frame_ns = frame_rate ? PAL_FRAME_NS : NTSC_FRAME_NS;
+	uint64_t now = SDL_GetTicksNS();
 
-	if(s_ppu->ppu->queued_cycles == 0)
+	screen->next_frame_ns += frame_ns;
+
+	if(screen->next_frame_ns > now)
 	{
-		ppu_dot(data_bus, frame_buffer);
+		SDL_DelayNS(screen->next_frame_ns - now);
 	}
-
-	if(*loop_state == Empty)
+	else if(now - screen->next_frame_ns > frame_ns)
 	{
-		if(cpu->NMI_line == 0)
-		{
-			hw_nmi(data_bus);
-		}
-		else if(cpu->IRQ_line == 0)
-		{
-			hw_irq(data_bus);
-		}
+		// more than a frame behind, don't try to make it up
+		screen->next_frame_ns = now;
 	}
+}
 
-	dma->alignment_counter++;
+void present_frame(struct Screen *screen, struct S_PPU *s_ppu)
+{
+	SDL_Rect area = { 0, 0, s_ppu->frame_width, s_ppu->frame_height };
+	SDL_FRect source = { 0, 0, s_ppu->frame_width, s_ppu->frame_height };
 
-	if(dma->alignment_counter == 8)
-	{
-		dma->alignment_counter = 0;
-	}
+	SDL_UpdateTexture(screen->texture, &area, s_ppu->frame_buffer, FRAME_MAX_WIDTH * sizeof(uint32_t));
 
-	if(*loop_state == Fetched)
+	SDL_RenderClear(screen->renderer);
+	SDL_RenderTexture(screen->renderer, screen->texture, &source, NULL);
+	SDL_RenderPresent(screen->renderer);
+}
+
+void run_snooze(struct Screen *screen, struct data_bus *data_bus)
+{
+	screen->next_frame_ns = SDL_GetTicksNS();
+
+	while(screen->running)
 	{
-		if(dma->queued_cycles == 0)
+		poll_events(screen, data_bus);
+
+		run_frame(data_bus);
+
+		TRACE_EVENT(TRACE_FRAME, TRACE_FRAME_DRAWN, 0, 0);
+		present_frame(screen, data_bus->B_bus.ppu);
+
+		if(!screen->turbo)
 		{
-			DMA_transfers(data_bus, dma->alignment_counter);
-			cpu->queued_cyles += dma->queued_cycles;
+			pace_frame(screen, data_bus->B_bus.ppu->ppu->frame_rate);
 		}
 	}
+}
+
+int init_snooze(struct Screen *screen)
+{
+	screen->running = 1;
 
-	if(cpu->RDY)
+	if(!screen_init_SDL(screen))
 	{
-		cpu->queued_cyles--;
+		return EXIT_FAILURE;
 	}
 
-	if(dma->dma_active)
+	return EXIT_SUCCESS;
+}
+
+// FNV-1a over the frame as shown, rows of frame_width pixels
+uint64_t frame_hash(struct S_PPU *s_ppu)
+{
+	uint64_t hash = 0xCBF29CE484222325;
+
+	for(int row = 0; row < s_ppu->frame_height; row++)
 	{
-		dma->queued_cycles--;
+		const uint8_t *pixels = (const uint8_t *)&s_ppu->frame_buffer[row * FRAME_MAX_WIDTH];
+
+		for(size_t i = 0; i < s_ppu->frame_width * sizeof(uint32_t); i++)
+		{
+			hash ^= pixels[i];
+			hash *= 0x00000100000001B3;
+		}
 	}
 
-	s_ppu->ppu->queued_cycles--;
+	return hash;
 }
 
-void run_snooze(struct Screen *screen, struct data_bus *data_bus)
+int run_headless(struct Headless *headless, struct data_bus *data_bus)
 {
-	SDL_Surface *frame_buffer = SDL_CreateSurface(DOTS, LINES, SDL_PIXELFORMAT_RGB24);
-	SDL_Surface *window_buffer = SDL_GetWindowSurface(screen->window);
+	struct S_PPU *s_ppu = data_bus->B_bus.ppu;
+	struct timespec start, end;
+	uint64_t hash = 0;
+	int frame = 0;
+	int matched = 0;
 
-	uint8_t instruction = 0x00;
-	enum LoopState loop_state = Empty;
+	s_ppu->skip_render = !headless->render;
 
-	while(screen->running)
-	{
-		while(SDL_PollEvent(&screen->event))
-		{
-			switch (screen->event.type) 
-			{
-				case SDL_EVENT_QUIT:
-					screen->running = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
 
-					break;
-				default:
-					break;
-			}
-		}
+	while(frame < headless->frames && !matched)
+	{
+		run_frame(data_bus);
+		TRACE_EVENT(TRACE_FRAME, TRACE_FRAME_DRAWN, 0, 0);
+		frame++;
 
-		if(!data_bus->A_Bus.cpu->LPM)
+		if(headless->render)
 		{
-			run_snooze_cycle(data_bus, frame_buffer, &loop_state, &instruction);
+			hash = frame_hash(s_ppu);
+			matched = headless->expect && hash == headless->expected_hash;
 		}
+	}
 
-		if(data_bus->B_bus.ppu->ppu->frame_finished)
-		{
-			printf("DRAW\n");
-			SDL_BlitSurface(frame_buffer, NULL, window_buffer, NULL);
-			SDL_UpdateWindowSurface(screen->window);
+	clock_gettime(CLOCK_MONOTONIC, &end);
 
-			data_bus->B_bus.ppu->ppu->frame_finished = 0;
-			SDL_Delay(1000 / 60);
-		}
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("frames: %d\n", frame);
+
+	if(headless->render)
+	{
+		printf("hash: %016llx\n", (unsigned long long)hash);
 	}
-}
 
-int init_snooze(struct Screen *screen)
-{
-	screen->running = 1;
+	printf("time: %.3f s, %.3f ms/frame, %.1f fps\n", seconds, seconds * 1000 / frame, frame / seconds);
 
-	if(!screen_init_SDL(screen))
+	if(headless->expect && !matched)
 	{
 		return EXIT_FAILURE;
 	}
@@ -200,29 +284,132 @@ int main(int argc, char *argv[])
 	struct Ricoh_5A22 cpu;
 	struct S_PPU s_ppu;
 	struct DMA dma;
+	struct Scheduler scheduler;
 
 	data_bus.A_Bus.memory = &memory;
 	data_bus.A_Bus.cpu = &cpu;
 	data_bus.B_bus.ppu = &s_ppu;
 	data_bus.B_bus.dma = &dma;
+	data_bus.scheduler = &scheduler;
+
+	const char *ROM_path = NULL;
+	const char *load_state_path = NULL;
+	int turbo = 0;
+
+	uint32_t trace_categories = 0;
+	const char *trace_path = NULL;
 
-	init_memory(&memory, LoROM_MARKER);
+	struct Headless headless = { 0 };
+	headless.frames = 60;
+	headless.render = 1;
 
-	if(argc > 1)
+	for(int i = 1; i < argc; i++)
 	{
-		load_ROM(argv[1], &data_bus);
+		if(strcmp(argv[i], "--turbo") == 0)
+		{
+			turbo = 1;
+		}
+		else if(strcmp(argv[i], "--load-state") == 0 && i + 1 < argc)
+		{
+			load_state_path = argv[++i];
+		}
+		else if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			trace_categories = parse_trace_categories(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--trace-file") == 0 && i + 1 < argc)
+		{
+			trace_path = argv[++i];
+		}
+		else if(strcmp(argv[i], "--headless") == 0)
+		{
+			headless.enabled = 1;
+		}
+		else if(strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			headless.frames = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--no-render") == 0)
+		{
+			headless.render = 0;
+		}
+		else if(strcmp(argv[i], "--expect-hash") == 0 && i + 1 < argc)
+		{
+			headless.expect = 1;
+			headless.expected_hash = strtoull(argv[++i], NULL, 16);
+		}
+		else 
+		{
+			ROM_path = argv[i];
+		}
+	}
+
+	if(headless.frames < 1)
+	{
+		printf("Failed start: --frames needs a count of at least 1\n");
+
+		return EXIT_FAILURE;
+	}
+
+	if(headless.expect && !headless.render)
+	{
+		printf("Failed start: --expect-hash needs rendered frames, it can't be used with --no-render\n");
+
+		return EXIT_FAILURE;
+	}
+
+	struct Cartridge cartridge = { 0 };
+	cartridge.ROM_type_marker = LoROM_MARKER;
+
+	if(ROM_path && !load_ROM(ROM_path, &cartridge))
+	{
+		return EXIT_FAILURE;
 	}
 
-	reset_ricoh_5a22(&data_bus);
+	init_memory(&memory, cartridge.ROM_type_marker, cartridge.ROM, cartridge.ROM_size);
+
+	init_ricoh_5a22(&data_bus);
 	init_s_ppu(&s_ppu);
 	init_DMA(&data_bus);
+	init_scheduler(&data_bus);
+
+	if(load_state_path && !load_state_file(&data_bus, load_state_path))
+	{
+		return EXIT_FAILURE;
+	}
+
+	if(trace_categories && !start_trace(trace_categories, trace_path))
+	{
+		return EXIT_FAILURE;
+	}
+
+	if(headless.enabled)
+	{
+		int status = run_headless(&headless, &data_bus);
+
+		stop_trace();
+		unload_ROM(&cartridge);
+
+		return status;
+	}
 
 	struct Screen screen = { 0 };
+	screen.turbo = turbo;
+
+	if(ROM_path)
+	{
+		screen.state_path = malloc(strlen(ROM_path) + strlen(".state") + 1);
+		sprintf(screen.state_path, "%s.state", ROM_path);
+	}
 
 	int exit_status = init_snooze(&screen);
 	run_snooze(&screen, &data_bus);
 
+	stop_trace();
+
 	free_screen(&screen);
+	free(screen.state_path);
+	unload_ROM(&cartridge);
 
 	return exit_status;
 
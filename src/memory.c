@@ -1,33 +1,107 @@
 #include "memory.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-void init_memory(struct Memory *memory, uint8_t ROM_type_marker)
+static uint8_t read_unmapped_register(struct data_bus *data_bus, uint32_t addr)
+{
+	return data_bus->open_value;
+}
+
+static void write_unmapped_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+
+}
+
+static struct register_handler unmapped_register = { read_unmapped_register, write_unmapped_register };
+
+struct register_handler *get_register(struct Memory *memory, uint32_t addr)
+{
+	uint16_t reg_addr = addr & 0x0000FFFF;
+
+	if((reg_addr & 0xFF00) == 0x2100)
+	{
+		return &memory->B_bus_registers[reg_addr & (B_BUS_REGISTERS - 1)];
+	}
+	else if((reg_addr & 0xFC00) == 0x4000)
+	{
+		return &memory->A_bus_registers[reg_addr & (A_BUS_REGISTERS - 1)];
+	}
+
+	return &unmapped_register;
+}
+
+void map_register(struct Memory *memory, uint16_t addr, register_read read, register_write write)
+{
+	struct register_handler *handler = get_register(memory, addr);
+
+	if(handler == &unmapped_register)
+	{
+		printf("Failed map: %04x not a register\n", addr);
+
+		return;
+	}
+
+	handler->read = read ? read : read_unmapped_register;
+	handler->write = write ? write : write_unmapped_register;
+}
+
+void map_registers(struct Memory *memory)
+{
+	for(int i = 0; i < B_BUS_REGISTERS; i++)
+	{
+		memory->B_bus_registers[i] = unmapped_register;
+	}
+
+	for(int i = 0; i < A_BUS_REGISTERS; i++)
+	{
+		memory->A_bus_registers[i] = unmapped_register;
+	}
+
+	map_ppu_registers(memory);
+	map_wram_registers(memory);
+	map_cpu_registers(memory);
+	map_dma_registers(memory);
+}
+
+void init_memory(struct Memory *memory, uint8_t ROM_type_marker, uint8_t *ROM, uint32_t ROM_size)
 {
 	memory->ROM_type_marker = ROM_type_marker;
+	memory->ROM_size = ROM_size;
 
 	memory->WRAM_addr = 0;
 	memory->WRAM = malloc(WRAM_SIZE * sizeof(uint8_t));
+	memory->WRAM_generation = calloc((WRAM_SIZE) >> PAGE_SHIFT, sizeof(uint32_t));
+	memory->ROM_generation = 0;
 	memory->REG = malloc(REG_SIZE * sizeof(uint8_t));
 
+	// the ROM is used where the cartridge loader put it, nothing is copied
 	if(ROM_type_marker == LoROM_MARKER)
 	{
-		memory->ROM.LoROM.ROM = malloc(LoROM_ROM_SIZE * sizeof(uint8_t));
+		memory->ROM.LoROM.ROM = ROM;
 		memory->ROM.LoROM.SRAM = malloc(LoROM_SRAM_SIZE * sizeof(uint8_t));
 	}
 	else if(ROM_type_marker == HiROM_MARKER)
-{
-		memory->ROM.HiROM.ROM = malloc(HiROM_ROM_SIZE * sizeof(uint8_t));
+	{
+		memory->ROM.HiROM.ROM = ROM;
 		memory->ROM.HiROM.SRAM = malloc(HiROM_SRAM_SIZE * sizeof(uint8_t));
 	}
 	else if(ROM_type_marker == ExHiROM_MARKER)
 	{
-		memory->ROM.ExHiROM.ROM = malloc(ExHiROM_ROM_SIZE * sizeof(uint8_t));
-		memory->ROM.ExHiROM.ExROM = malloc(ExHiROM_ExROM_SIZE * sizeof(uint8_t));
+		memory->ROM.ExHiROM.ROM = ROM;
+		memory->ROM.ExHiROM.ExROM = ROM_size > ExHiROM_ROM_SIZE ? ROM + ExHiROM_ROM_SIZE : ROM;
 		memory->ROM.ExHiROM.SRAM = malloc(ExHiROM_SRAM_SIZE * sizeof(uint8_t));
 	}
+
+	memory->page_table = malloc(N_PAGES * sizeof(struct page));
+
+	memory->B_bus_registers = malloc(B_BUS_REGISTERS * sizeof(struct register_handler));
+	memory->A_bus_registers = malloc(A_BUS_REGISTERS * sizeof(struct register_handler));
+
+	map_memory(memory);
+	map_registers(memory);
 }
 
 int is_within_area(uint32_t index, uint8_t bank_0, uint16_t bytes_0, uint8_t bank_1, uint16_t bytes_1)
@@ -166,6 +240,68 @@ uint32_t LoROM_SRAM_mirror_indexer(uint32_t index)
 	return new_index;
 }
 
+// banks $C0-$FF are whole, $80-$BF only have their upper half, both start at bank * 64 KiB
+uint32_t HiROM_ROM_indexer(uint32_t index)
+{
+	uint32_t new_index = 0;	
+	uint8_t bank_byte = (index & 0x00FF0000) >> 16;
+	uint16_t low_bytes = index & 0x0000FFFF;
+
+	uint32_t bank_width = (HiROM_ROM_BYTES[1] + 1) - HiROM_ROM_BYTES[0];
+
+	uint8_t bank_offset = bank_byte & 0x3F;
+
+	new_index = (bank_offset * bank_width) + low_bytes;
+
+	return new_index;
+}
+
+uint32_t HiROM_SRAM_indexer(uint32_t index)
+{
+	uint32_t new_index = 0;	
+	uint8_t bank_byte = (index & 0x00FF0000) >> 16;
+	uint16_t low_bytes = index & 0x0000FFFF;
+
+	uint32_t bank_width = (HiROM_SRAM_BYTES[1] + 1) - HiROM_SRAM_BYTES[0];
+
+	uint8_t bank_offset = bank_byte - HiROM_SRAM_BANKS[0];
+	uint16_t byte_offset = low_bytes - HiROM_SRAM_BYTES[0];
+
+	new_index = (bank_offset * bank_width) + byte_offset;
+
+	return new_index;
+}
+
+// same as HiROM, but $00-$7D reach the part of the image past the first 4 MiB
+uint32_t ExHiROM_ROM_indexer(uint32_t index)
+{
+	uint32_t new_index = HiROM_ROM_indexer(index);
+	uint8_t bank_byte = (index & 0x00FF0000) >> 16;
+
+	if(bank_byte < 0x80)
+	{
+		new_index += ExHiROM_ROM_SIZE;
+	}
+
+	return new_index;
+}
+
+uint32_t ExHiROM_SRAM_indexer(uint32_t index)
+{
+	uint32_t new_index = 0;	
+	uint8_t bank_byte = (index & 0x00FF0000) >> 16;
+	uint16_t low_bytes = index & 0x0000FFFF;
+
+	uint32_t bank_width = (ExHiROM_SRAM_BYTES[1] + 1) - ExHiROM_SRAM_BYTES[0];
+
+	uint8_t bank_offset = bank_byte - ExHiROM_SRAM_BANKS[0];
+	uint16_t byte_offset = low_bytes - ExHiROM_SRAM_BYTES[0];
+
+	new_index = (bank_offset * bank_width) + byte_offset;
+
+	return new_index;
+}
+
 uint32_t convert_to_cartridge_addr(uint32_t addr)
 {
 	uint32_t cartridge_addr = addr;
@@ -184,15 +320,13 @@ uint32_t convert_to_cartridge_addr(uint32_t addr)
 
 uint8_t read_register_raw(struct data_bus *data_bus, uint32_t addr)
 {
-	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
-
-	if(IN_REG(cartridge_addr))
+	if(REG_INDEX(addr) < REG_BANK_BYTES)
 	{
-		return data_bus->A_Bus.memory->REG[REG_indexer(cartridge_addr)];
+		return data_bus->A_Bus.memory->REG[REG_INDEX(addr)];
 	}
 	else 
 	{
-		printf("Failed read: %06x not a register\n", cartridge_addr);
+		printf("Failed read: %06x not a register\n", addr);
 
 		return data_bus->open_value;
 	}
@@ -200,11 +334,9 @@ uint8_t read_register_raw(struct data_bus *data_bus, uint32_t addr)
 
 void write_register_raw(struct data_bus *data_bus, uint32_t addr, uint8_t val)
 {
-	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
-
-	if(IN_REG(cartridge_addr))
+	if(REG_INDEX(addr) < REG_BANK_BYTES)
 	{
-		data_bus->A_Bus.memory->REG[REG_indexer(cartridge_addr)] = val;
+		data_bus->A_Bus.memory->REG[REG_INDEX(addr)] = val;
 	}
 	else 
 	{
@@ -212,115 +344,206 @@ void write_register_raw(struct data_bus *data_bus, uint32_t addr, uint8_t val)
 	}
 }
 
-void ROM_write(struct data_bus *data_bus, uint32_t addr, uint8_t val)
+// offset into a ROM_size image, sizes that aren't a power of two repeat their last part
+// the way the cartridge's address decoding does
+uint32_t ROM_mirror(uint32_t offset, uint32_t ROM_size)
 {
-	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
+	uint32_t base = 0;
+	uint32_t mask = 0x00800000;
 
-	if(IN_LoROM_ROM(cartridge_addr))
+	if(ROM_size == 0)
 	{
-		data_bus->A_Bus.memory->ROM.LoROM.ROM[LoROM_ROM_indexer(cartridge_addr)] = val;
+		return 0;
 	}
-	else if(IN_LoROM_ROM_MIRROR(cartridge_addr))
+
+	while(offset >= ROM_size)
 	{
-		data_bus->A_Bus.memory->ROM.LoROM.ROM[LoROM_ROM_mirror_indexer(cartridge_addr)] = val;
+		while(!(offset & mask))
+		{
+			mask >>= 1;
+		}
+
+		offset -= mask;
+
+		if(ROM_size > mask)
+		{
+			ROM_size -= mask;
+			base += mask;
+		}
+
+		mask >>= 1;
 	}
+
+	return base + offset;
 }
 
-uint8_t mem_read(struct data_bus *data_bus, uint32_t addr)
+void map_page(struct Memory *memory, uint32_t page)
 {
+	uint32_t addr = page << PAGE_SHIFT;
 	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
+	struct page *entry = &memory->page_table[page];
+
+	entry->ptr = NULL;
+	entry->type = PAGE_OPEN_BUS;
+	entry->generation = NULL;
 
 	if(IN_WRAM(cartridge_addr))
 	{
-		data_bus->open_value = data_bus->A_Bus.memory->WRAM[WRAM_indexer(cartridge_addr)];
+		entry->ptr = &memory->WRAM[WRAM_indexer(cartridge_addr)];
+		entry->type = PAGE_RAM;
+		entry->generation = &memory->WRAM_generation[WRAM_indexer(cartridge_addr) >> PAGE_SHIFT];
 	}
 	else if(IN_WRAM_LOWRAM_MIRROR(cartridge_addr))
 	{
-		data_bus->open_value = data_bus->A_Bus.memory->WRAM[WRAM_lowRAM_mirror_indexer(cartridge_addr)];
+		entry->ptr = &memory->WRAM[WRAM_lowRAM_mirror_indexer(cartridge_addr)];
+		entry->type = PAGE_RAM;
+		entry->generation = &memory->WRAM_generation[WRAM_lowRAM_mirror_indexer(cartridge_addr) >> PAGE_SHIFT];
 	}
 	else if(IN_REG(cartridge_addr))
 	{
-		uint32_t reg_addr = cartridge_addr - 0x800000;
-
-		read_ppu_register(data_bus, reg_addr);
-		read_wram_register(data_bus, reg_addr);
-		read_cpu_register(data_bus, reg_addr);
-		read_dma_register(data_bus, reg_addr);
-
-		data_bus->open_value = data_bus->A_Bus.memory->REG[REG_indexer(cartridge_addr)];
+		entry->type = PAGE_REG;
 	}
-	else if(data_bus->A_Bus.memory->ROM_type_marker == LoROM_MARKER)
+	else if(memory->ROM_type_marker == LoROM_MARKER)
 	{
-		if(IN_LoROM_ROM(cartridge_addr))
+		if(IN_LoROM_ROM(cartridge_addr) && memory->ROM_size)
 		{
-			data_bus->open_value = data_bus->A_Bus.memory->ROM.LoROM.ROM[LoROM_ROM_indexer(cartridge_addr)];
+			entry->ptr = &memory->ROM.LoROM.ROM[ROM_mirror(LoROM_ROM_indexer(cartridge_addr), memory->ROM_size)];
+			entry->type = PAGE_ROM;
+			entry->generation = &memory->ROM_generation;
 		}
-		else if(IN_LoROM_ROM_MIRROR(cartridge_addr))
+		else if(IN_LoROM_ROM_MIRROR(cartridge_addr) && memory->ROM_size)
 		{
-			data_bus->open_value = data_bus->A_Bus.memory->ROM.LoROM.ROM[LoROM_ROM_mirror_indexer(cartridge_addr)];
+			entry->ptr = &memory->ROM.LoROM.ROM[ROM_mirror(LoROM_ROM_mirror_indexer(cartridge_addr), memory->ROM_size)];
+			entry->type = PAGE_ROM;
+			entry->generation = &memory->ROM_generation;
 		}	
 		else if(IN_LoROM_SRAM(cartridge_addr))
 		{
-			data_bus->open_value = data_bus->A_Bus.memory->ROM.LoROM.SRAM[LoROM_SRAM_indexer(cartridge_addr)];
+			entry->ptr = &memory->ROM.LoROM.SRAM[LoROM_SRAM_indexer(cartridge_addr)];
+			entry->type = PAGE_RAM;
 		}
 		else if(IN_LoROM_SRAM_MIRROR(cartridge_addr))
 		{
-			data_bus->open_value = data_bus->A_Bus.memory->ROM.LoROM.SRAM[LoROM_SRAM_mirror_indexer(cartridge_addr)];
+			entry->ptr = &memory->ROM.LoROM.SRAM[LoROM_SRAM_mirror_indexer(cartridge_addr)];
+			entry->type = PAGE_RAM;
 		}
-		else 
+	}
+	else if(memory->ROM_type_marker == HiROM_MARKER)
+	{
+		if((IN_HiROM_ROM(cartridge_addr) || IN_HiROM_ROM_MIRROR(cartridge_addr)) && memory->ROM_size)
+		{
+			entry->ptr = &memory->ROM.HiROM.ROM[ROM_mirror(HiROM_ROM_indexer(cartridge_addr), memory->ROM_size)];
+			entry->type = PAGE_ROM;
+			entry->generation = &memory->ROM_generation;
+		}
+		else if(IN_HiROM_SRAM(cartridge_addr))
 		{
-			printf("LoROM UNKNOWN\n");
+			entry->ptr = &memory->ROM.HiROM.SRAM[HiROM_SRAM_indexer(cartridge_addr)];
+			entry->type = PAGE_RAM;
 		}
 	}
-	else 
+	else if(memory->ROM_type_marker == ExHiROM_MARKER)
 	{
-		printf("UNKNOWN\n");
+		if((IN_ExHiROM_ROM(addr) || IN_ExHiROM_ROM_MIRROR(addr) || IN_ExHiROM_ExROM(addr) || IN_ExHiROM_ExROM_MIRROR(addr)) && memory->ROM_size)
+		{
+			entry->ptr = &memory->ROM.ExHiROM.ROM[ROM_mirror(ExHiROM_ROM_indexer(addr), memory->ROM_size)];
+			entry->type = PAGE_ROM;
+			entry->generation = &memory->ROM_generation;
+		}
+		else if(IN_ExHiROM_SRAM(cartridge_addr))
+		{
+			entry->ptr = &memory->ROM.ExHiROM.SRAM[ExHiROM_SRAM_indexer(cartridge_addr)];
+			entry->type = PAGE_RAM;
+		}
 	}
-
-	return data_bus->open_value; // open bus
 }
 
-void mem_write(struct data_bus *data_bus, uint32_t addr, uint8_t write_val)
+uint8_t page_access_cycles(struct Memory *memory, uint32_t page, int fast_ROM)
 {
-	uint32_t cartridge_addr = convert_to_cartridge_addr(addr);
+	uint8_t bank = (page << PAGE_SHIFT) >> 16;
+	struct page *entry = &memory->page_table[page];
 
-	if(IN_WRAM(cartridge_addr))
+	if(entry->type == PAGE_REG)
 	{
-		data_bus->A_Bus.memory->WRAM[WRAM_indexer(cartridge_addr)] = write_val;
+		// every system bank has its own $4000 page
+		if(((page << PAGE_SHIFT) & 0xF000) == 0x4000)
+		{
+			return MIXED_ACCESS;
+		}
+
+		return FAST_ACCESS;
 	}
-	else if(IN_WRAM_LOWRAM_MIRROR(cartridge_addr))
+	else if(entry->type == PAGE_ROM && fast_ROM && bank >= 0x80)
 	{
-		data_bus->A_Bus.memory->WRAM[WRAM_lowRAM_mirror_indexer(cartridge_addr)] = write_val;
+		return FAST_ACCESS;
 	}
-	else if(IN_REG(cartridge_addr))
+
+	return MEDIUM_ACCESS;
+}
+
+void map_access_cycles(struct Memory *memory, int fast_ROM)
+{
+	for(uint32_t page = 0; page < N_PAGES; page++)
+	{
+		memory->page_table[page].access_cycles = page_access_cycles(memory, page, fast_ROM);
+	}
+}
+
+void map_memory(struct Memory *memory)
+{
+	for(uint32_t page = 0; page < N_PAGES; page++)
 	{
-		uint32_t reg_addr = cartridge_addr - 0x800000;
+		map_page(memory, page);
+	}
 
-		write_ppu_register(data_bus, reg_addr, write_val);
-		write_wram_register(data_bus, reg_addr, write_val);
-		write_cpu_register(data_bus, reg_addr, write_val);
-		write_dma_register(data_bus, reg_addr, write_val);
+	map_access_cycles(memory, 0);
+}
 
-		data_bus->A_Bus.memory->REG[REG_indexer(cartridge_addr)] = write_val;
+uint8_t read_page(struct data_bus *data_bus, struct page *page, uint32_t addr)
+{
+	if(page->ptr)
+	{
+		data_bus->open_value = page->ptr[addr & PAGE_MASK];
 	}
-	else if(data_bus->A_Bus.memory->ROM_type_marker == LoROM_MARKER)
+	else if(page->type == PAGE_REG)
 	{
-		if(IN_LoROM_ROM(cartridge_addr))
-		{
-			printf("WRITE TO ROM: %06x\n", addr);
-		}
-		else if(IN_LoROM_ROM_MIRROR(cartridge_addr))
-		{
-			printf("WRITE TO ROM: %06x\n", addr);
-		}	
-		else if(IN_LoROM_SRAM(cartridge_addr))
-		{
-			data_bus->A_Bus.memory->ROM.LoROM.SRAM[LoROM_SRAM_indexer(cartridge_addr)] = write_val;
-		}
-		else if(IN_LoROM_SRAM_MIRROR(cartridge_addr))
+		data_bus->open_value = get_register(data_bus->A_Bus.memory, addr)->read(data_bus, addr & 0x0000FFFF);
+	}
+
+	return data_bus->open_value; // open bus
+}
+
+uint8_t mem_read(struct data_bus *data_bus, uint32_t addr)
+{
+	return read_page(data_bus, &data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)], addr);
+}
+
+void write_page(struct data_bus *data_bus, struct page *page, uint32_t addr, uint8_t write_val)
+{
+	if(page->type == PAGE_RAM)
+	{
+		page->ptr[addr & PAGE_MASK] = write_val;
+
+		if(page->generation)
 		{
-			data_bus->A_Bus.memory->ROM.LoROM.SRAM[LoROM_SRAM_mirror_indexer(cartridge_addr)] = write_val;
+			(*page->generation)++;
 		}
 	}
+	else if(page->type == PAGE_REG)
+	{
+		uint32_t reg_addr = addr & 0x0000FFFF;
+
+		get_register(data_bus->A_Bus.memory, addr)->write(data_bus, reg_addr, write_val);
+
+		data_bus->A_Bus.memory->REG[REG_INDEX(reg_addr)] = write_val;
+	}
+	else if(page->type == PAGE_ROM)
+	{
+		TRACE_EVENT(TRACE_MEMORY, TRACE_ROM_WRITE, addr, 0);
+	}
 }
 
+void mem_write(struct data_bus *data_bus, uint32_t addr, uint8_t write_val)
+{
+	write_page(data_bus, &data_bus->A_Bus.memory->page_table[PAGE_INDEX(addr)], addr, write_val);
+}
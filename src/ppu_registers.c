@@ -1,9 +1,11 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "memory.h"
 #include "PPU.h"
 #include "registers.h"
 #include "utility.h"
+#include "trace.h"
 
 uint16_t read_VRAM(struct data_bus *data_bus, uint16_t addr)
 {
@@ -14,23 +16,29 @@ void write_VRAM_word(struct data_bus *data_bus, uint16_t addr, uint16_t word)
 {
 	data_bus->B_bus.ppu->memory->VRAM[addr * 2] = LE_LBYTE16(word);
 	data_bus->B_bus.ppu->memory->VRAM[addr * 2 + 1] = LE_HBYTE16(word);
+
+	invalidate_tile(data_bus, addr);
 }
 
 void write_VRAM_low(struct data_bus *data_bus, uint16_t addr, uint8_t byte)
 {
 	data_bus->B_bus.ppu->memory->VRAM[addr * 2] = byte;
+
+	invalidate_tile(data_bus, addr);
 }
 
 void write_VRAM_high(struct data_bus *data_bus, uint16_t addr, uint8_t byte)
 {
 	data_bus->B_bus.ppu->memory->VRAM[addr * 2 + 1] = byte;
+
+	invalidate_tile(data_bus, addr);
 }
 
 uint8_t read_OAM(struct data_bus *data_bus, uint16_t addr)
 {
 	if(check_bit16(addr, 0x0200))
 	{
-		return data_bus->B_bus.ppu->memory->OAM_high_table[addr & 0x01FF];
+		return data_bus->B_bus.ppu->memory->OAM_high_table[addr & 0x001F];
 	}
 	else 
 	{
@@ -42,430 +50,700 @@ void write_OAM(struct data_bus *data_bus, uint16_t addr, uint8_t byte)
 {
 	if(check_bit16(addr, 0x0200))
 	{
-		data_bus->B_bus.ppu->memory->OAM_high_table[addr & 0x01FF] = byte;
+		data_bus->B_bus.ppu->memory->OAM_high_table[addr & 0x001F] = byte;
 	}
 	else 
 	{
 		data_bus->B_bus.ppu->memory->OAM_low_table[addr & 0x01FF] = byte;
 	}
+
+	data_bus->B_bus.ppu->ppu->OAM_dirty = 1;
 }
 
 void write_CGRAM_word(struct data_bus *data_bus, uint16_t addr, uint16_t word)
 {
 	data_bus->B_bus.ppu->memory->CGRAM[addr * 2] = LE_LBYTE16(word);
 	data_bus->B_bus.ppu->memory->CGRAM[addr * 2 + 1] = LE_HBYTE16(word);
+
+	data_bus->B_bus.ppu->memory->palette[addr] = word;
 }
 
 uint16_t read_CGRAM(struct data_bus *data_bus, uint16_t addr)
 {
-	return LE_COMBINE_2BYTE(data_bus->B_bus.ppu->memory->CGRAM[addr * 2], data_bus->B_bus.ppu->memory->CGRAM[addr * 2 + 1]);
+	return data_bus->B_bus.ppu->memory->palette[addr];
 }
 
-void write_ppu_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+static void write_INIDISP(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
 {
 	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(addr == INIDISP)
-	{
-		if(check_bit8(write_value, 0x80))
-		{
-			ppu->F_blank = 1;
-		}
-		else 
-		{
-			ppu->F_blank = 0;
-		}
+	flush_line(data_bus);
 
-		ppu->brightness = write_value & 0b00001111;
+	if(check_bit8(write_value, 0x80))
+	{
+		ppu->F_blank = 1;
 	}
-
-	if(addr == OBJSEL)
+	else 
 	{
-		switch((write_value & 0b11100000) >> 5)
-		{
-			case 0:
-				ppu->obj_sizes[0] = S_8x8;
-				ppu->obj_sizes[1] = S_16x16;
-
-				break;	
-			case 1:
-				ppu->obj_sizes[0] = S_8x8;
-				ppu->obj_sizes[1] = S_32x32;
-
-				break;
-			case 2:
-				ppu->obj_sizes[0] = S_8x8;
-				ppu->obj_sizes[1] = S_64x64;
-
-				break;
-			case 3:
-				ppu->obj_sizes[0] = S_16x16;
-				ppu->obj_sizes[1] = S_32x32;
-
-				break;
-			case 4:
-				ppu->obj_sizes[0] = S_16x16;
-				ppu->obj_sizes[1] = S_64x64;
-
-				break;
-			case 5:
-				ppu->obj_sizes[0] = S_32x32;
-				ppu->obj_sizes[1] = S_64x64;
-
-				break;
-			case 6:
-				ppu->obj_sizes[0] = S_16x32;
-				ppu->obj_sizes[1] = S_32x64;
-
-				break;
-			case 7:
-				ppu->obj_sizes[0] = S_16x32;
-				ppu->obj_sizes[1] = S_32x32;
-
-				break;
-			default:
-				break;
-		}
-
-		ppu->name_select = (write_value & 0b00011000) >> 3;
-		ppu->name_base_addr = write_value & 0b00000111;
+		ppu->F_blank = 0;
 	}
 
-	if(addr == BGMODE)
+	ppu->brightness = write_value & 0b00001111;
+}
+
+static void write_OBJSEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	switch((write_value & 0b11100000) >> 5)
 	{
-		if(check_bit8(write_value, 0b10000000))
-		{
-			ppu->BGn_character_size[3] = CH_SIZE_16x16;
-		}
-		else
-		{
-			ppu->BGn_character_size[3] = CH_SIZE_8x8;
-		}
+		case 0:
+			ppu->obj_sizes[0] = S_8x8;
+			ppu->obj_sizes[1] = S_16x16;
+
+			break;	
+		case 1:
+			ppu->obj_sizes[0] = S_8x8;
+			ppu->obj_sizes[1] = S_32x32;
+
+			break;
+		case 2:
+			ppu->obj_sizes[0] = S_8x8;
+			ppu->obj_sizes[1] = S_64x64;
+
+			break;
+		case 3:
+			ppu->obj_sizes[0] = S_16x16;
+			ppu->obj_sizes[1] = S_32x32;
+
+			break;
+		case 4:
+			ppu->obj_sizes[0] = S_16x16;
+			ppu->obj_sizes[1] = S_64x64;
+
+			break;
+		case 5:
+			ppu->obj_sizes[0] = S_32x32;
+			ppu->obj_sizes[1] = S_64x64;
+
+			break;
+		case 6:
+			ppu->obj_sizes[0] = S_16x32;
+			ppu->obj_sizes[1] = S_32x64;
+
+			break;
+		case 7:
+			ppu->obj_sizes[0] = S_16x32;
+			ppu->obj_sizes[1] = S_32x32;
+
+			break;
+		default:
+			break;
+	}
 
-		if(check_bit8(write_value, 0b01000000))
-		{
-			ppu->BGn_character_size[2] = CH_SIZE_16x16;
-		}
-		else 
-		{
-			ppu->BGn_character_size[2] = CH_SIZE_8x8;
-		}
+	ppu->name_select = (write_value & 0b00011000) >> 3;
+	ppu->name_base_addr = write_value & 0b00000111;
+	ppu->OAM_dirty = 1;
+}
 
-		if(check_bit8(write_value, 0b00100000))
-		{
-			ppu->BGn_character_size[1] = CH_SIZE_16x16;
-		}
-		else 
-		{
-			ppu->BGn_character_size[1] = CH_SIZE_8x8;
-		}
+static void write_BGMODE(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-		if(check_bit8(write_value, 0b00010000))
-		{
-			ppu->BGn_character_size[0] = CH_SIZE_16x16;
-		}
-		else 
-		{
-			ppu->BGn_character_size[0] = CH_SIZE_8x8;
-		}
+	flush_line(data_bus);
 
-		ppu->M1_BG3_priority = check_bit8(write_value, 0b00001000);
-		ppu->BG_mode = write_value & 0b00000111;
+	if(check_bit8(write_value, 0b10000000))
+	{
+		ppu->BGn_character_size[3] = CH_SIZE_16x16;
 	}
-
-	if(addr == BG1SC)
+	else
 	{
-		ppu->BGn_tilemap_info.tilemap_vram_addr[0] = write_value >> 2;
-		ppu->BGn_tilemap_info.vertical_tilemaps[0] = check_bit8(write_value, 0b00000010) + 1;
-		ppu->BGn_tilemap_info.horizontal_tilemaps[0] = check_bit8(write_value, 0b00000001) + 1;
+		ppu->BGn_character_size[3] = CH_SIZE_8x8;
 	}
 
-	if(addr == BG2SC)
+	if(check_bit8(write_value, 0b01000000))
 	{
-		ppu->BGn_tilemap_info.tilemap_vram_addr[1] = write_value >> 2;
-		ppu->BGn_tilemap_info.vertical_tilemaps[1] = check_bit8(write_value, 0b00000010) + 1;
-		ppu->BGn_tilemap_info.horizontal_tilemaps[1] = check_bit8(write_value, 0b00000001) + 1;
+		ppu->BGn_character_size[2] = CH_SIZE_16x16;
 	}
-
-	if(addr == BG3SC)
+	else 
 	{
-		ppu->BGn_tilemap_info.tilemap_vram_addr[2] = write_value >> 2;
-		ppu->BGn_tilemap_info.vertical_tilemaps[2] = check_bit8(write_value, 0b00000010) + 1;
-		ppu->BGn_tilemap_info.horizontal_tilemaps[2] = check_bit8(write_value, 0b00000001) + 1;
+		ppu->BGn_character_size[2] = CH_SIZE_8x8;
 	}
 
-	if(addr == BG4SC)
+	if(check_bit8(write_value, 0b00100000))
 	{
-		ppu->BGn_tilemap_info.tilemap_vram_addr[3] = write_value >> 2;
-		ppu->BGn_tilemap_info.vertical_tilemaps[3] = check_bit8(write_value, 0b00000010) + 1;
-		ppu->BGn_tilemap_info.horizontal_tilemaps[3] = check_bit8(write_value, 0b00000001) + 1;
+		ppu->BGn_character_size[1] = CH_SIZE_16x16;
 	}
-
-	if(addr == BG12NBA)
+	else 
 	{
-		ppu->BGn_chr_tiles_offset[1] = (write_value & 0b11110000) >> 4;
-		ppu->BGn_chr_tiles_offset[0] = write_value & 0b00001111;
+		ppu->BGn_character_size[1] = CH_SIZE_8x8;
 	}
 
-	if(addr == BG34NBA)
+	if(check_bit8(write_value, 0b00010000))
 	{
-		ppu->BGn_chr_tiles_offset[3] = (write_value & 0b11110000) >> 4;
-		ppu->BGn_chr_tiles_offset[2] = write_value & 0b00001111;
+		ppu->BGn_character_size[0] = CH_SIZE_16x16;
 	}
-
-	if(addr == BG1HOFS)
+	else 
 	{
-		ppu->BG_scroll_offset.BGn_horizontal_offset[0] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[0] |= ppu->BG_scroll_offset.BG_offset_latch & 0b11111000;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[0] |= ppu->BG_scroll_offset.PPU2_horizontal_latch;
-
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
-		ppu->BG_scroll_offset.PPU2_horizontal_latch = write_value & 0b00000111;
+		ppu->BGn_character_size[0] = CH_SIZE_8x8;
 	}
 
-	if(addr == BG1VOFS)
-	{
-		ppu->BG_scroll_offset.BGn_vertical_offset[0] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_vertical_offset[0] |= ppu->BG_scroll_offset.BG_offset_latch;
+	ppu->M1_BG3_priority = check_bit8(write_value, 0b00001000);
+	ppu->BG_mode = write_value & 0b00000111;
+}
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
-	}
+static void write_BGnSC(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	int n = addr - BG1SC;
+
+	flush_line(data_bus);
+
+	ppu->BGn_tilemap_info.tilemap_vram_addr[n] = write_value >> 2;
+	ppu->BGn_tilemap_info.vertical_tilemaps[n] = check_bit8(write_value, 0b00000010) + 1;
+	ppu->BGn_tilemap_info.horizontal_tilemaps[n] = check_bit8(write_value, 0b00000001) + 1;
+}
+
+static void write_BGnNBA(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	int n = (addr - BG12NBA) * 2;
+
+	flush_line(data_bus);
+
+	ppu->BGn_chr_tiles_offset[n + 1] = (write_value & 0b11110000) >> 4;
+	ppu->BGn_chr_tiles_offset[n] = write_value & 0b00001111;
+}
+
+static void write_BGnHOFS(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	int n = (addr - BG1HOFS) / 2;
+
+	flush_line(data_bus);
+
+	ppu->BG_scroll_offset.BGn_horizontal_offset[n] = (0x0000 | write_value) << 8;
+	ppu->BG_scroll_offset.BGn_horizontal_offset[n] |= ppu->BG_scroll_offset.BG_offset_latch & 0b11111000;
+	ppu->BG_scroll_offset.BGn_horizontal_offset[n] |= ppu->BG_scroll_offset.PPU2_horizontal_latch;
+
+	ppu->BG_scroll_offset.BG_offset_latch = write_value;
+	ppu->BG_scroll_offset.PPU2_horizontal_latch = write_value & 0b00000111;
 
-	if(addr == BG2HOFS)
+	// BG1HOFS doubles as M7HOFS, which has its own latch
+	if(n == 0)
 	{
-		ppu->BG_scroll_offset.BGn_horizontal_offset[1] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[1] |= ppu->BG_scroll_offset.BG_offset_latch & 0b11111000;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[1] |= ppu->BG_scroll_offset.PPU2_horizontal_latch;
+		ppu->M7_matrices.horizontal_offset = LE_COMBINE_2BYTE(ppu->M7_matrices.latch, write_value);
+		ppu->M7_matrices.latch = write_value;
+	}
+}
+
+static void write_BGnVOFS(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	int n = (addr - BG1VOFS) / 2;
+
+	flush_line(data_bus);
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
-		ppu->BG_scroll_offset.PPU2_horizontal_latch = write_value & 0b00000111;
+	ppu->BG_scroll_offset.BGn_vertical_offset[n] = (0x0000 | write_value) << 8;
+	ppu->BG_scroll_offset.BGn_vertical_offset[n] |= ppu->BG_scroll_offset.BG_offset_latch;
+
+	ppu->BG_scroll_offset.BG_offset_latch = write_value;
+
+	if(n == 0)
+	{
+		ppu->M7_matrices.vertical_offset = LE_COMBINE_2BYTE(ppu->M7_matrices.latch, write_value);
+		ppu->M7_matrices.latch = write_value;
 	}
+}
+
+static void write_VMAIN(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(addr == BG2VOFS)
+	ppu->VRAM_increment_mode = check_bit8(write_value, 0b10000000);
+
+	switch ((write_value & 0b00001100) >> 2)
 	{
-		ppu->BG_scroll_offset.BGn_vertical_offset[1] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_vertical_offset[1] |= ppu->BG_scroll_offset.BG_offset_latch;
+		case 0:
+			ppu->VRAM_remap = None;
+			
+			break;
+		case 1:
+			ppu->VRAM_remap = M_2bpp;
+
+			break;
+		case 2: 
+			ppu->VRAM_remap = M_4bpp;
+			
+			break;
+		case 3:
+			ppu->VRAM_remap = M_8bpp;
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
+			break;
+		default:
+			break;
 	}
 
-	if(addr == BG3HOFS)
+	switch (write_value & 0b00000011)
 	{
-		ppu->BG_scroll_offset.BGn_horizontal_offset[2] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[2] |= ppu->BG_scroll_offset.BG_offset_latch & 0b11111000;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[2] |= ppu->BG_scroll_offset.PPU2_horizontal_latch;
+		case 0:
+			ppu->address_increment = 1;
+			
+			break;
+		case 1:
+			ppu->address_increment = 32;
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
-		ppu->BG_scroll_offset.PPU2_horizontal_latch = write_value & 0b00000111;
+			break;
+		case 2: 
+			ppu->address_increment = 128;
+		
+			break;
+		case 3:
+			ppu->address_increment = 128;
+
+			break;
+		default:
+			break;
 	}
+}
+
+static void write_TM(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	ppu->OBJ_main_enable = check_bit8(write_value, 0b00010000);
+	ppu->BGn_main_enable[3] = check_bit8(write_value, 0b00001000);
+	ppu->BGn_main_enable[2] = check_bit8(write_value, 0b00000100);
+	ppu->BGn_main_enable[1] = check_bit8(write_value, 0b00000010);
+	ppu->BGn_main_enable[0] = check_bit8(write_value, 0b00000001);
+}
+
+static void write_M7SEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
 
-	if(addr == BG3VOFS)
+	ppu->tilemap_repeat = check_bit8(write_value, 0b10000000);
+	ppu->non_tilemap_fill = check_bit8(write_value, 0b01000000);
+	ppu->flip_BG_vertical = check_bit8(write_value, 0b00000010);
+	ppu->flip_BG_horizontal = check_bit8(write_value, 0b00000001);
+}
+
+static void write_M7n(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	uint16_t value = LE_COMBINE_2BYTE(ppu->M7_matrices.latch, write_value);
+
+	flush_line(data_bus);
+
+	switch(addr)
 	{
-		ppu->BG_scroll_offset.BGn_vertical_offset[2] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_vertical_offset[2] |= ppu->BG_scroll_offset.BG_offset_latch;
+		case M7A:
+			ppu->M7_matrices.A = value;
+			ppu->M7_matrices.signed_16bit_mult = (int16_t)value;
+
+			break;
+		case M7B:
+			ppu->M7_matrices.B = value;
+			ppu->M7_matrices.signed_8bit_mult = (int8_t)write_value;
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
+			break;
+		case M7C:
+			ppu->M7_matrices.C = value;
+
+			break;
+		case M7D:
+			ppu->M7_matrices.D = value;
+
+			break;
+		case M7X:
+			ppu->M7_matrices.center_X = value;
+
+			break;
+		case M7Y:
+			ppu->M7_matrices.center_Y = value;
+
+			break;
 	}
 
-	if(addr == BG4HOFS)
+	ppu->M7_matrices.latch = write_value;
+
+	// MPYL-MPYH, M7A times the last byte written to M7B
+	ppu->multiplication_result = (uint32_t)(ppu->M7_matrices.signed_16bit_mult * ppu->M7_matrices.signed_8bit_mult) & 0x00FFFFFF;
+}
+
+static void write_WnSEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	// W12SEL -> BG1/BG2, W34SEL -> BG3/BG4, WOBJSEL -> OBJ/color
+	if(addr == WOBJSEL)
 	{
-		ppu->BG_scroll_offset.BGn_horizontal_offset[3] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[3] |= ppu->BG_scroll_offset.BG_offset_latch & 0b11111000;
-		ppu->BG_scroll_offset.BGn_horizontal_offset[3] |= ppu->BG_scroll_offset.PPU2_horizontal_latch;
+		ppu->window_select.invert_OBJ_window_1 = check_bit8(write_value, 0b00000001);
+		ppu->window_select.enable_OBJ_window_1 = check_bit8(write_value, 0b00000010);
+		ppu->window_select.invert_OBJ_window_2 = check_bit8(write_value, 0b00000100);
+		ppu->window_select.enable_OBJ_window_2 = check_bit8(write_value, 0b00001000);
+
+		ppu->window_select.invert_color_window_1 = check_bit8(write_value, 0b00010000);
+		ppu->window_select.enable_color_window_1 = check_bit8(write_value, 0b00100000);
+		ppu->window_select.invert_color_window_2 = check_bit8(write_value, 0b01000000);
+		ppu->window_select.enable_color_window_2 = check_bit8(write_value, 0b10000000);
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
-		ppu->BG_scroll_offset.PPU2_horizontal_latch = write_value & 0b00000111;
+		return;
 	}
 
-	if(addr == BG4VOFS)
+	int n = (addr - W12SEL) * 2;
+
+	for(int i = 0; i < 2; i++)
 	{
-		ppu->BG_scroll_offset.BGn_vertical_offset[3] = (0x0000 | write_value) << 8;
-		ppu->BG_scroll_offset.BGn_vertical_offset[3] |= ppu->BG_scroll_offset.BG_offset_latch;
+		uint8_t bits = write_value >> (i * 4);
 
-		ppu->BG_scroll_offset.BG_offset_latch = write_value;
+		ppu->window_select.invert_BGn_window_1[n + i] = check_bit8(bits, 0b00000001);
+		ppu->window_select.enable_BGn_window_1[n + i] = check_bit8(bits, 0b00000010);
+		ppu->window_select.invert_BGn_window_2[n + i] = check_bit8(bits, 0b00000100);
+		ppu->window_select.enable_BGn_window_2[n + i] = check_bit8(bits, 0b00001000);
 	}
+}
+
+static void write_WHn(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
 
-	if(addr == VMAIN)
+	switch(addr)
 	{
-		ppu->VRAM_increment_mode = check_bit8(write_value, 0b10000000);
+		case WH0:
+			ppu->window_position.W1_left = write_value;
 
-		switch ((write_value & 0b00001100) >> 2)
-		{
-			case 0:
-				ppu->VRAM_remap = None;
-				
-				break;
-			case 1:
-				ppu->VRAM_remap = M_2bpp;
-
-				break;
-			case 2: 
-				ppu->VRAM_remap = M_4bpp;
-				
-				break;
-			case 3:
-				ppu->VRAM_remap = M_8bpp;
-
-				break;
-			default:
-				break;
-		}
+			break;
+		case WH1:
+			ppu->window_position.W1_right = write_value;
 
-		switch (write_value & 0b00000011)
-		{
-			case 0:
-				ppu->address_increment = 1;
-				
-				break;
-			case 1:
-				ppu->address_increment = 32;
-
-				break;
-			case 2: 
-				ppu->address_increment = 128;
-			
-				break;
-			case 3:
-				ppu->address_increment = 128;
+			break;
+		case WH2:
+			ppu->window_position.W2_left = write_value;
 
-				break;
-			default:
-				break;
-		}
+			break;
+		case WH3:
+			ppu->window_position.W2_right = write_value;
+
+			break;
 	}
+}
 
-	if(addr == TM)
+static void write_WBGLOG(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	for(int n = 0; n < 4; n++)
 	{
-		ppu->OBJ_main_enable = check_bit8(write_value, 0b00010000);
-		ppu->BGn_main_enable[3] = check_bit8(write_value, 0b00001000);
-		ppu->BGn_main_enable[2] = check_bit8(write_value, 0b00000100);
-		ppu->BGn_main_enable[1] = check_bit8(write_value, 0b00000010);
-		ppu->BGn_main_enable[0] = check_bit8(write_value, 0b00000001);
+		ppu->BGn_window_mask[n] = (write_value >> (n * 2)) & 0b00000011;
 	}
+}
 
-	if(addr == COLDATA)
-	{
-		if(check_bit8(write_value, 0b10000000))
-		{
-			ppu->fixed_blue = write_value & 0b00011111;
-		}
+static void write_WOBJLOG(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-		if(check_bit8(write_value, 0b01000000))
-		{
-			ppu->fixed_green = write_value & 0b00011111;
-		}
+	flush_line(data_bus);
 
-		if(check_bit8(write_value, 0b00100000))
-		{
-			ppu->fixed_red = write_value & 0b00011111;
-		}
-	}
+	ppu->OBJ_window_mask = write_value & 0b00000011;
+	ppu->Color_window_mask = (write_value & 0b00001100) >> 2;
+}
+
+static void write_TS(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(addr == SETINI)
+	flush_line(data_bus);
+
+	ppu->OBJ_sub_enable = check_bit8(write_value, 0b00010000);
+	ppu->BGn_sub_enable[3] = check_bit8(write_value, 0b00001000);
+	ppu->BGn_sub_enable[2] = check_bit8(write_value, 0b00000100);
+	ppu->BGn_sub_enable[1] = check_bit8(write_value, 0b00000010);
+	ppu->BGn_sub_enable[0] = check_bit8(write_value, 0b00000001);
+}
+
+static void write_TMW(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	ppu->apply_window_OBJ_main = check_bit8(write_value, 0b00010000);
+	ppu->apply_window_BGn_main[3] = check_bit8(write_value, 0b00001000);
+	ppu->apply_window_BGn_main[2] = check_bit8(write_value, 0b00000100);
+	ppu->apply_window_BGn_main[1] = check_bit8(write_value, 0b00000010);
+	ppu->apply_window_BGn_main[0] = check_bit8(write_value, 0b00000001);
+}
+
+static void write_TSW(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	ppu->apply_window_OBJ_sub = check_bit8(write_value, 0b00010000);
+	ppu->apply_window_BGn_sub[3] = check_bit8(write_value, 0b00001000);
+	ppu->apply_window_BGn_sub[2] = check_bit8(write_value, 0b00000100);
+	ppu->apply_window_BGn_sub[1] = check_bit8(write_value, 0b00000010);
+	ppu->apply_window_BGn_sub[0] = check_bit8(write_value, 0b00000001);
+}
+
+static void write_CGWSEL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	ppu->mainscreen_black_region = (write_value & 0b11000000) >> 6;
+	ppu->subscreen_transparent_region = (write_value & 0b00110000) >> 4;
+	ppu->addend = check_bit8(write_value, 0b00000010);
+	ppu->direct_color = check_bit8(write_value, 0b00000001);
+}
+
+static void write_CGADSUB(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	ppu->operator = check_bit8(write_value, 0b10000000);
+	ppu->half_color_math = check_bit8(write_value, 0b01000000);
+	ppu->backdrop_color_math = check_bit8(write_value, 0b00100000);
+	ppu->obj_color_math = check_bit8(write_value, 0b00010000);
+	ppu->BGn_color_math[3] = check_bit8(write_value, 0b00001000);
+	ppu->BGn_color_math[2] = check_bit8(write_value, 0b00000100);
+	ppu->BGn_color_math[1] = check_bit8(write_value, 0b00000010);
+	ppu->BGn_color_math[0] = check_bit8(write_value, 0b00000001);
+}
+
+static void write_COLDATA(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	flush_line(data_bus);
+
+	if(check_bit8(write_value, 0b10000000))
 	{
-		ppu->external_image_sync = check_bit8(write_value, 0b10000000);
-		ppu->M7_EXTBG = check_bit8(write_value, 0b01000000);
-		ppu->high_res = check_bit8(write_value, 0b00001000);
-		ppu->overscan = check_bit8(write_value, 0b00000100);
-		ppu->OBJ_interlacing = check_bit8(write_value, 0b00000010);
-		ppu->screen_interlacing = check_bit8(write_value, 0b00000001);
+		ppu->fixed_blue = write_value & 0b00011111;
 	}
 
-	if(addr == OAMADDL)
+	if(check_bit8(write_value, 0b01000000))
 	{
-		ppu->OAM_addr = LE_COMBINE_2BYTE(read_register_raw(data_bus, OAMADDL), read_register_raw(data_bus, OAMADDH)) * 2;
+		ppu->fixed_green = write_value & 0b00011111;
 	}
 
-	if(addr == OAMADDH)
+	if(check_bit8(write_value, 0b00100000))
 	{
-		ppu->OAM_addr = LE_COMBINE_2BYTE(read_register_raw(data_bus, OAMADDL), read_register_raw(data_bus, OAMADDH)) * 2;
+		ppu->fixed_red = write_value & 0b00011111;
 	}
+}
 
-	if(addr == OAMDATA)
-	{
-		if(!check_bit16(ppu->OAM_addr, 0x0001))
-		{
-			ppu->OAM_latch = write_value;
-		}
-		else if(ppu->OAM_addr < OAM_LTABLE_BYTES)
-		{
-			write_OAM(data_bus, ppu->OAM_addr - 1, ppu->OAM_latch);
-			write_OAM(data_bus, ppu->OAM_addr, write_value);
-		}
-		
-		if(ppu->OAM_addr >= OAM_LTABLE_BYTES)
-		{
-			write_OAM(data_bus, ppu->OAM_addr, write_value);
-		}
+static void write_SETINI(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-		ppu->OAM_addr++;
-	}
+	flush_line(data_bus);
+
+	ppu->external_image_sync = check_bit8(write_value, 0b10000000);
+	ppu->M7_EXTBG = check_bit8(write_value, 0b01000000);
+	ppu->high_res = check_bit8(write_value, 0b00001000);
+	ppu->overscan = check_bit8(write_value, 0b00000100);
+	ppu->OBJ_interlacing = check_bit8(write_value, 0b00000010);
+	ppu->screen_interlacing = check_bit8(write_value, 0b00000001);
+}
+
+static void write_OAMADDL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	ppu->OAM_addr = LE_COMBINE_2BYTE(write_value, read_register_raw(data_bus, OAMADDH)) * 2;
+	ppu->first_sprite = check_bit8(read_register_raw(data_bus, OAMADDH), 0x80) ? (write_value >> 1) & 0x7F : 0;
+}
 
-	if(addr == VMADDL)
+static void write_OAMADDH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	ppu->OAM_addr = LE_COMBINE_2BYTE(read_register_raw(data_bus, OAMADDL), write_value) * 2;
+	ppu->first_sprite = check_bit8(write_value, 0x80) ? (read_register_raw(data_bus, OAMADDL) >> 1) & 0x7F : 0;
+}
+
+static void push_OAMDATA(struct data_bus *data_bus, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(!check_bit16(ppu->OAM_addr, 0x0001))
 	{
-		// cannot read during blanks
-		ppu->VRAM_addr = LE_COMBINE_2BYTE(write_value, LE_HBYTE16(ppu->VRAM_addr));
-		printf("\n\nNEW ADDR %04x\n", ppu->VRAM_addr);
-		ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
+		ppu->OAM_latch = write_value;
+	}
+	else if(ppu->OAM_addr < OAM_LTABLE_BYTES)
+	{
+		write_OAM(data_bus, ppu->OAM_addr - 1, ppu->OAM_latch);
+		write_OAM(data_bus, ppu->OAM_addr, write_value);
+	}
+	
+	if(ppu->OAM_addr >= OAM_LTABLE_BYTES)
+	{
+		write_OAM(data_bus, ppu->OAM_addr, write_value);
 	}
 
-	if(addr == VMADDH)
+	ppu->OAM_addr++;
+}
+
+static void write_OAMDATA(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	flush_line(data_bus);
+
+	push_OAMDATA(data_bus, write_value);
+}
+
+void write_OAMDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count)
+{
+	flush_line(data_bus);
+
+	for(int i = 0; i < count; i++)
 	{
-		// cannot read during blanks
-		ppu->VRAM_addr = LE_COMBINE_2BYTE(LE_LBYTE16(ppu->VRAM_addr), write_value);
-		// printf("%04x\n", ppu->VRAM_addr);
-		ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
+		push_OAMDATA(data_bus, bytes[i]);
 	}
+}
+
+static void write_VMADDL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(addr == VMDATAL)
+	// cannot read during blanks
+	ppu->VRAM_addr = LE_COMBINE_2BYTE(write_value, LE_HBYTE16(ppu->VRAM_addr));
+	TRACE_EVENT(TRACE_VRAM, TRACE_VRAM_ADDR, ppu->VRAM_addr, 0);
+	ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
+}
+
+static void write_VMADDH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	// cannot read during blanks
+	ppu->VRAM_addr = LE_COMBINE_2BYTE(LE_LBYTE16(ppu->VRAM_addr), write_value);
+	// printf("%04x\n", ppu->VRAM_addr);
+	ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
+}
+
+static void push_VMDATA(struct data_bus *data_bus, int high, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(high)
+	{
+		write_VRAM_high(data_bus, ppu->VRAM_addr, write_value);
+	}
+	else 
 	{
 		write_VRAM_low(data_bus, ppu->VRAM_addr, write_value);
+	}
 
-		printf("%04x - %d%d%d%d%d%d%d%d\n",
-				ppu->VRAM_addr,
-				check_bit8(write_value, 0x80),
-				check_bit8(write_value, 0x40),
-				check_bit8(write_value, 0x20),
-				check_bit8(write_value, 0x10),
-				check_bit8(write_value, 0x08),
-				check_bit8(write_value, 0x04),
-				check_bit8(write_value, 0x02),
-				check_bit8(write_value, 0x01));
-		if(ppu->VRAM_increment_mode == 0)
-		{
-			ppu->VRAM_addr++;
-		}
+	if(ppu->VRAM_increment_mode == high)
+	{
+		ppu->VRAM_addr++;
 	}
+}
 
-	if(addr == VMDATAH)
-	{	
-		write_VRAM_high(data_bus, ppu->VRAM_addr, write_value);
+static void write_VMDATAL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-		if(ppu->VRAM_increment_mode == 1)
+	flush_line(data_bus);
+
+	TRACE_EVENT(TRACE_VRAM, TRACE_VRAM_WRITE, ppu->VRAM_addr, write_value);
+
+	push_VMDATA(data_bus, 0, write_value);
+}
+
+static void write_VMDATAH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{	
+	flush_line(data_bus);
+
+	push_VMDATA(data_bus, 1, write_value);
+}
+
+// port 0 is VMDATAL and 1 is VMDATAH, alternate switches port after every byte
+void write_VMDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count, int port, int alternate)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	int words = count / 2;
+
+	flush_line(data_bus);
+
+	// low, high, low, high with the address stepping after high is a straight copy
+	if(alternate && port == 0 && ppu->VRAM_increment_mode == 1 && count % 2 == 0 && ppu->VRAM_addr + words <= VRAM_WORDS)
+	{
+		memcpy(&data_bus->B_bus.ppu->memory->VRAM[ppu->VRAM_addr * 2], bytes, count);
+
+		for(int i = 0; i < words; i++)
 		{
-			ppu->VRAM_addr++;
+			invalidate_tile(data_bus, ppu->VRAM_addr + i);
 		}
+
+		ppu->VRAM_addr += words;
+
+		return;
 	}
 
-	if(addr == CGADD)
+	for(int i = 0; i < count; i++)
+	{
+		push_VMDATA(data_bus, alternate ? (port + i) & 1 : port, bytes[i]);
+	}
+}
+
+static void write_CGADD(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	ppu->CGRAM_addr = write_value;
+	ppu->CGRAM_check = 0;
+}
+
+static void push_CGDATA(struct data_bus *data_bus, uint8_t write_value)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(!ppu->CGRAM_check)
+	{
+		ppu->CGRAM_latch = write_value;
+		ppu->CGRAM_check = 1;
+	}
+	else 
 	{
-		ppu->CGRAM_addr = write_value;
+		write_CGRAM_word(data_bus, ppu->CGRAM_addr, LE_COMBINE_2BYTE(ppu->CGRAM_latch, write_value));
+		ppu->CGRAM_addr++;
 		ppu->CGRAM_check = 0;
 	}
+}
+
+static void write_CGDATA(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	flush_line(data_bus);
+
+	push_CGDATA(data_bus, write_value);
+}
 
-	if(addr == CGDATA)
+void write_CGDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count)
+{
+	flush_line(data_bus);
+
+	for(int i = 0; i < count; i++)
 	{
-		if(!ppu->CGRAM_check)
-		{
-			ppu->CGRAM_latch = write_value;
-			ppu->CGRAM_check = 1;
-		}
-		else 
-		{
-			write_CGRAM_word(data_bus, ppu->CGRAM_addr, LE_COMBINE_2BYTE(ppu->CGRAM_latch, write_value));
-			ppu->CGRAM_addr++;
-			ppu->CGRAM_check = 0;
-		}
+		push_CGDATA(data_bus, bytes[i]);
 	}
 }
 
@@ -496,198 +774,262 @@ void clear_HVCT(struct data_bus *data_bus)
 	}
 }
 
-void read_ppu_register(struct data_bus *data_bus, uint32_t addr)
+static uint8_t read_PPU1_open_bus(struct data_bus *data_bus, uint32_t addr)
+{
+	return data_bus->B_bus.ppu->ppu->PPU1_bus;
+}
+
+static uint8_t read_MPYn(struct data_bus *data_bus, uint32_t addr)
 {
 	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(addr == MPYL) { ppu->PPU1_bus = 0x00; }
-	if(addr == MPYM) { ppu->PPU1_bus = 0x00; }
-	if(addr == MPYH) { ppu->PPU1_bus = 0x00; }
+	ppu->PPU1_bus = (uint8_t)(ppu->multiplication_result >> ((addr - MPYL) * 8));
 
-	if(addr == OAMDATAREAD)
-	{
-		uint8_t read = read_OAM(data_bus, ppu->OAM_addr);
-		write_register_raw(data_bus, OAMDATAREAD, read);
-		ppu->PPU1_bus = read;
+	return ppu->PPU1_bus;
+}
 
-		ppu->OAM_addr++;
-	}
+static uint8_t read_OAMDATAREAD(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	ppu->PPU1_bus = read_OAM(data_bus, ppu->OAM_addr);
+	ppu->OAM_addr++;
 
-	if(addr == OAMDATAREAD) { write_register_raw(data_bus, OAMDATAREAD, ppu->PPU1_bus); }
-	if(addr == BGMODE) { write_register_raw(data_bus, BGMODE, ppu->PPU1_bus); }
-	if(addr == MOSAIC) { write_register_raw(data_bus, MOSAIC, ppu->PPU1_bus); }
-	if(addr == BG2SC) { write_register_raw(data_bus, BG2SC, ppu->PPU1_bus); }
-	if(addr == BG3SC) { write_register_raw(data_bus, BG3SC, ppu->PPU1_bus); }
-	if(addr == BG4SC) { write_register_raw(data_bus, BG4SC, ppu->PPU1_bus); }
+	return ppu->PPU1_bus;
+}
 
-	if(addr == BG4VOFS) { write_register_raw(data_bus, BG4VOFS, ppu->PPU1_bus); }
-	if(addr == VMAIN) { write_register_raw(data_bus, VMAIN, ppu->PPU1_bus); }
-	if(addr == VMADDL) { write_register_raw(data_bus, VMADDL, ppu->PPU1_bus); }
-	if(addr == VMDATAL) { write_register_raw(data_bus, VMDATAL, ppu->PPU1_bus); }
-	if(addr == VMDATAH) { write_register_raw(data_bus, VMDATAH, ppu->PPU1_bus); }
-	if(addr == M7SEL) { write_register_raw(data_bus, M7SEL, ppu->PPU1_bus); }
+static uint8_t read_VMDATALREAD(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-	if(addr == W34SEL) { write_register_raw(data_bus, W34SEL, ppu->PPU1_bus); }
-	if(addr == WOBJSEL) { write_register_raw(data_bus, WOBJSEL, ppu->PPU1_bus); }
-	if(addr == WH0) { write_register_raw(data_bus, WH0, ppu->PPU1_bus); }
-	if(addr == WH2) { write_register_raw(data_bus, WH2, ppu->PPU1_bus); }
-	if(addr == WH3) { write_register_raw(data_bus, WH3, ppu->PPU1_bus); }
-	if(addr == WBGLOG) { write_register_raw(data_bus, WBGLOG, ppu->PPU1_bus); }
+	ppu->PPU1_bus = LE_LBYTE16(ppu->VRAM_latch);
 
-	if(addr == VMDATALREAD)
+	if(ppu->VRAM_increment_mode == 0)
 	{
-		uint8_t read = LE_LBYTE16(ppu->VRAM_latch);
-		write_register_raw(data_bus, VMDATALREAD, read);
-		ppu->PPU1_bus = read;
+		ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
+		ppu->VRAM_addr++;
+	}
 
-		if(ppu->VRAM_increment_mode == 0)
-		{
-			ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
-			ppu->VRAM_addr++;
-		}
+	return ppu->PPU1_bus;
+}
+
+static uint8_t read_VMDATAHREAD(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	ppu->PPU1_bus = LE_HBYTE16(ppu->VRAM_latch);
+
+	if(ppu->VRAM_increment_mode == 1)
+	{
+		ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
+		ppu->VRAM_addr++;
 	}
 
-	if(addr == VMDATAHREAD)
+	return ppu->PPU1_bus;
+}
+
+static uint8_t read_CGDATAREAD(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(ppu->CGRAM_check)
 	{
-		uint8_t read = LE_HBYTE16(ppu->VRAM_latch);
-		write_register_raw(data_bus, VMDATALREAD, read);
-		ppu->PPU1_bus = read;
+		uint8_t read =  LE_HBYTE16(read_CGRAM(data_bus, ppu->CGRAM_addr));
+		ppu->PPU2_bus = (read & (~0x80)) | (ppu->PPU2_bus & 0x80);
 
-		if(ppu->VRAM_increment_mode == 1)
-		{
-			ppu->VRAM_latch = read_VRAM(data_bus, ppu->VRAM_addr);
-			ppu->VRAM_addr++;
-		}
+		ppu->CGRAM_check = 0;
 	}
-
-	if(addr == CGDATAREAD)
+	else
 	{
+		ppu->PPU2_bus = LE_LBYTE16(read_CGRAM(data_bus, ppu->CGRAM_addr));
 
-		if(ppu->CGRAM_check)
-		{
-			uint8_t read =  LE_HBYTE16(read_CGRAM(data_bus, ppu->CGRAM_addr));
-			read = (read & (~0x80)) | (ppu->PPU2_bus & 0x80);
-			write_register_raw(data_bus, CGDATAREAD, read);
-			ppu->PPU2_bus = read;
+		ppu->CGRAM_check = 1;
+	}
 
-			ppu->CGRAM_check = 0;
-		}
-		else
-		{
-			uint8_t read =  LE_LBYTE16(read_CGRAM(data_bus, ppu->CGRAM_addr));
-			write_register_raw(data_bus, CGDATAREAD, read);
-			ppu->PPU2_bus = read;
+	return ppu->PPU2_bus;
+}
 
-			ppu->CGRAM_check = 1;
-		}
+static uint8_t read_SLHV(struct data_bus *data_bus, uint32_t addr)
+{
+	if(read_register_raw(data_bus, WRIO) & 0x80)
+	{
+		latch_HVCT(data_bus);
 	}
 
-	if(addr == SLHV)
+	return data_bus->open_value;
+}
+
+static uint8_t read_OPHCT(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(ppu->OPHCT_byte == 0)
 	{
-		if(read_register_raw(data_bus, WRIO) & 0x80)
-		{
-			latch_HVCT(data_bus);
-		}
+		ppu->PPU2_bus = LE_LBYTE16(ppu->hscan_counter);
 	}
-
-	if(addr == OPHCT)	
+	else 
 	{
-		if(ppu->OPHCT_byte == 0)
-		{
-			uint8_t read = LE_LBYTE16(ppu->hscan_counter);
-			write_register_raw(data_bus, addr, read);
-			ppu->PPU2_bus = read;
-		}
-		else 
-		{
-			uint8_t read = LE_HBYTE16(ppu->hscan_counter);
-			read = (read & 0x01) | (ppu->PPU2_bus & (~0x01));
-			write_register_raw(data_bus, addr, read);
-			ppu->PPU2_bus = read;
-		}
+		uint8_t read = LE_HBYTE16(ppu->hscan_counter);
+		ppu->PPU2_bus = (read & 0x01) | (ppu->PPU2_bus & (~0x01));
+	}
+
+	ppu->OPHCT_byte = ~ppu->OPHCT_byte;
+
+	return ppu->PPU2_bus;
+}
+
+static uint8_t read_OPVCT(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
 
-		ppu->OPHCT_byte = ~ppu->OPHCT_byte;
+	if(ppu->OPVCT_byte == 0)
+	{
+		ppu->PPU2_bus = LE_LBYTE16(ppu->vscan_counter);
+	}
+	else 
+	{
+		uint8_t read = LE_HBYTE16(ppu->vscan_counter);
+		ppu->PPU2_bus = (read & 0x01) | (ppu->PPU2_bus & (~0x01));
 	}
 
-	if(addr == OPVCT)	
+	ppu->OPVCT_byte = ~ppu->OPVCT_byte;
+
+	return ppu->PPU2_bus;
+}
+
+static uint8_t read_STAT77(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	uint8_t stat = 0x00;
+
+	if(ppu->time_over)
 	{
-		if(ppu->OPVCT_byte == 0)
-		{
-			uint8_t read = LE_LBYTE16(ppu->vscan_counter);
-			write_register_raw(data_bus, addr, read);
-			ppu->PPU2_bus = read;
-		}
-		else 
-		{
-			uint8_t read = LE_HBYTE16(ppu->vscan_counter);
-			read = (read & 0x01) | (ppu->PPU2_bus & (~0x01));
-			write_register_raw(data_bus, addr, read);
-			ppu->PPU2_bus = read;
-		}
+		stat |= 0x80;
+	}
 
-		ppu->OPVCT_byte = ~ppu->OPVCT_byte;
+	if(ppu->range_over)
+	{
+		stat |= 0x40;
 	}
 
-	if(addr == STAT77)
+	if(ppu->pin_25)
 	{
-		uint8_t stat = 0x00;
+		stat |= 0x20;
+	}
 
-		if(ppu->time_over)
-		{
-			stat |= 0x80;
-		}
+	stat |= ppu->PPU1_bus & 0x10;
+	stat |= ppu->PPU1_version & 0b00001111;
 
-		if(ppu->range_over)
-		{
-			stat |= 0x40;
-		}
+	ppu->PPU1_bus = stat;
 
-		if(ppu->pin_25)
-		{
-			stat |= 0x20;
-		}
+	return stat;
+}
+
+static uint8_t read_STAT78(struct data_bus *data_bus, uint32_t addr)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	uint8_t stat = 0x00;
 
-		stat |= ppu->PPU1_bus & 0x10;
-		stat |= ppu->PPU1_version & 0b00001111;
+	ppu->OPVCT_byte = 0;
+	ppu->OPHCT_byte = 0;
 
-		write_register_raw(data_bus, addr, stat);
-		ppu->PPU1_bus = stat;
+	if(read_register_raw(data_bus, WRIO) & 0x80)
+	{
+		ppu->counter_latch = 0;
 	}
 
-	if(addr == STAT78)
+	if(ppu->interlace_field)
 	{
-		uint8_t stat = 0x00;
+		stat |= 0x80;
+	}
 
-		ppu->OPVCT_byte = 0;
-		ppu->OPHCT_byte = 0;
+	if(ppu->counter_latch)
+	{
+		stat |= 0x40;
+	}
 
-		if(read_register_raw(data_bus, WRIO) & 0x80)
-		{
-			ppu->counter_latch = 0;
-		}
+	stat |= ppu->PPU2_bus & 0x20;
 
-		if(ppu->interlace_field)
-		{
-			stat |= 0x80;
-		}
+	if(ppu->frame_rate)
+	{
+		// 0 -> 60hz, 1 -> 50hz
+		// will always be 60hz because in NTSC mode (525 lines)
+		stat |= 0x10;
+	}
 
-		if(ppu->counter_latch)
-		{
-			stat |= 0x40;
-		}
+	stat |= ppu->PPU2_version & 0b00001111;
 
-		stat |= ppu->PPU2_bus & 0x20;
+	ppu->PPU2_bus = stat;
 
-		if(ppu->frame_rate)
-		{
-			// 0 -> 60hz, 1 -> 50hz
-			// will always be 60hz because in NTSC mode (525 lines)
-			stat |= 0x10;
-		}
+	return stat;
+}
+
+void map_ppu_registers(struct Memory *memory)
+{
+	map_register(memory, INIDISP, NULL, write_INIDISP);
+	map_register(memory, OBJSEL, NULL, write_OBJSEL);
+	map_register(memory, OAMADDL, NULL, write_OAMADDL);
+	map_register(memory, OAMADDH, NULL, write_OAMADDH);
+	map_register(memory, OAMDATA, read_PPU1_open_bus, write_OAMDATA);
+	map_register(memory, BGMODE, read_PPU1_open_bus, write_BGMODE);
+	map_register(memory, MOSAIC, read_PPU1_open_bus, NULL);
+
+	for(uint16_t reg = BG1SC; reg <= BG4SC; reg++)
+	{
+		map_register(memory, reg, reg == BG1SC ? NULL : read_PPU1_open_bus, write_BGnSC);
+	}
 
-		stat |= ppu->PPU2_version & 0b00001111;
+	map_register(memory, BG12NBA, NULL, write_BGnNBA);
+	map_register(memory, BG34NBA, NULL, write_BGnNBA);
 
-		write_register_raw(data_bus, addr, stat);
-		ppu->PPU2_bus = stat;
+	for(uint16_t reg = BG1HOFS; reg <= BG4VOFS; reg += 2)
+	{
+		map_register(memory, reg, NULL, write_BGnHOFS);
+		map_register(memory, reg + 1, reg + 1 == BG4VOFS ? read_PPU1_open_bus : NULL, write_BGnVOFS);
+	}
+
+	map_register(memory, VMAIN, read_PPU1_open_bus, write_VMAIN);
+	map_register(memory, VMADDL, read_PPU1_open_bus, write_VMADDL);
+	map_register(memory, VMADDH, NULL, write_VMADDH);
+	map_register(memory, VMDATAL, read_PPU1_open_bus, write_VMDATAL);
+	map_register(memory, VMDATAH, read_PPU1_open_bus, write_VMDATAH);
+	map_register(memory, M7SEL, read_PPU1_open_bus, write_M7SEL);
+
+	for(uint16_t reg = M7A; reg <= M7Y; reg++)
+	{
+		map_register(memory, reg, NULL, write_M7n);
 	}
+
+	map_register(memory, CGADD, NULL, write_CGADD);
+	map_register(memory, CGDATA, NULL, write_CGDATA);
+	map_register(memory, W12SEL, NULL, write_WnSEL);
+	map_register(memory, W34SEL, read_PPU1_open_bus, write_WnSEL);
+	map_register(memory, WOBJSEL, read_PPU1_open_bus, write_WnSEL);
+	map_register(memory, WH0, read_PPU1_open_bus, write_WHn);
+	map_register(memory, WH1, NULL, write_WHn);
+	map_register(memory, WH2, read_PPU1_open_bus, write_WHn);
+	map_register(memory, WH3, read_PPU1_open_bus, write_WHn);
+	map_register(memory, WBGLOG, read_PPU1_open_bus, write_WBGLOG);
+	map_register(memory, WOBJLOG, NULL, write_WOBJLOG);
+	map_register(memory, TM, NULL, write_TM);
+	map_register(memory, TS, NULL, write_TS);
+	map_register(memory, TMW, NULL, write_TMW);
+	map_register(memory, TSW, NULL, write_TSW);
+	map_register(memory, CGWSEL, NULL, write_CGWSEL);
+	map_register(memory, CGADSUB, NULL, write_CGADSUB);
+	map_register(memory, COLDATA, NULL, write_COLDATA);
+	map_register(memory, SETINI, NULL, write_SETINI);
+
+	map_register(memory, MPYL, read_MPYn, NULL);
+	map_register(memory, MPYM, read_MPYn, NULL);
+	map_register(memory, MPYH, read_MPYn, NULL);
+	map_register(memory, SLHV, read_SLHV, NULL);
+	map_register(memory, OAMDATAREAD, read_OAMDATAREAD, NULL);
+	map_register(memory, VMDATALREAD, read_VMDATALREAD, NULL);
+	map_register(memory, VMDATAHREAD, read_VMDATAHREAD, NULL);
+	map_register(memory, CGDATAREAD, read_CGDATAREAD, NULL);
+	map_register(memory, OPHCT, read_OPHCT, NULL);
+	map_register(memory, OPVCT, read_OPVCT, NULL);
+	map_register(memory, STAT77, read_STAT77, NULL);
+	map_register(memory, STAT78, read_STAT78, NULL);
 }
@@ -0,0 +1,1043 @@
+#include "PPU.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "utility.h"
+#include <stdint.h>
+#include <string.h>
+
+struct tilemap
+{
+	int flip_vertical;
+	int flip_horizontal;
+	int priority;
+	uint8_t palette;
+	uint16_t character;
+};
+
+static void get_tile(struct tilemap *tilemap, struct data_bus *data_bus, uint16_t VRAM_addr)
+{
+	uint16_t tilemap_data = read_VRAM(data_bus, VRAM_addr & VRAM_ADDR_MASK);
+
+	tilemap->flip_vertical = check_bit16(tilemap_data, 0x8000);
+	tilemap->flip_horizontal = check_bit16(tilemap_data, 0x4000);
+	tilemap->priority = check_bit16(tilemap_data, 0x2000);
+	tilemap->palette = (tilemap_data & 0b0001110000000000) >> 10;
+	tilemap->character = tilemap_data & 0b0000001111111111;
+}
+
+struct layer_order
+{
+	int layer;
+	int priority;
+};
+
+// back to front, the backdrop sits behind all of them
+static const struct layer_order mode0_order[] = 
+{
+	{3, 0}, {2, 0}, {OBJ_LAYER, 0}, {3, 1}, {2, 1}, {OBJ_LAYER, 1},
+	{1, 0}, {0, 0}, {OBJ_LAYER, 2}, {1, 1}, {0, 1}, {OBJ_LAYER, 3}, {-1, 0}
+};
+
+static const struct layer_order mode1_order[] = 
+{
+	{2, 0}, {OBJ_LAYER, 0}, {2, 1}, {OBJ_LAYER, 1},
+	{1, 0}, {0, 0}, {OBJ_LAYER, 2}, {1, 1}, {0, 1}, {OBJ_LAYER, 3}, {-1, 0}
+};
+
+static const struct layer_order mode1_BG3_order[] = 
+{
+	{2, 0}, {OBJ_LAYER, 0}, {OBJ_LAYER, 1},
+	{1, 0}, {0, 0}, {OBJ_LAYER, 2}, {1, 1}, {0, 1}, {OBJ_LAYER, 3}, {2, 1}, {-1, 0}
+};
+
+static const struct layer_order mode2_order[] = 
+{
+	{1, 0}, {OBJ_LAYER, 0}, {0, 0}, {OBJ_LAYER, 1}, 
+	{1, 1}, {OBJ_LAYER, 2}, {0, 1}, {OBJ_LAYER, 3}, {-1, 0}
+};
+
+static const struct layer_order mode6_order[] = 
+{
+	{OBJ_LAYER, 0}, {0, 0}, {OBJ_LAYER, 1}, {OBJ_LAYER, 2}, {0, 1}, {OBJ_LAYER, 3}, {-1, 0}
+};
+
+static const struct layer_order mode7_order[] = 
+{
+	{OBJ_LAYER, 0}, {0, 0}, {OBJ_LAYER, 1}, {OBJ_LAYER, 2}, {OBJ_LAYER, 3}, {-1, 0}
+};
+
+static const struct layer_order mode7_EXTBG_order[] = 
+{
+	{1, 0}, {OBJ_LAYER, 0}, {0, 0}, {OBJ_LAYER, 1}, {1, 1}, {OBJ_LAYER, 2}, {OBJ_LAYER, 3}, {-1, 0}
+};
+
+// bits per pixel of BG1-4 in modes 0-6, 0 -> layer doesn't exist
+static const int mode_bpp[7][BG_LAYERS] = 
+{
+	{2, 2, 2, 2},
+	{4, 4, 2, 0},
+	{4, 4, 0, 0},
+	{8, 4, 0, 0},
+	{8, 2, 0, 0},
+	{4, 2, 0, 0},
+	{4, 0, 0, 0}
+};
+
+static int visible_y(struct PPU *ppu, int y)
+{
+	int lines = ppu->overscan ? FRAME_OVERSCAN_LINES : FRAME_LINES;
+
+	return HIDE_LINES <= y && y < (lines * 2) + HIDE_LINES;
+}
+
+static int visible_line(struct PPU *ppu)
+{
+	return visible_y(ppu, ppu->y);
+}
+
+// first pixel of the line the beam hasn't drawn yet
+static int beam_pixel(struct PPU *ppu)
+{
+	int pixel = (ppu->x - HIDE_DOTS) / 2;
+
+	if(pixel < 0)
+	{
+		return 0;
+	}
+
+	if(pixel > LINE_PIXELS)
+	{
+		return LINE_PIXELS;
+	}
+
+	return pixel;
+}
+
+static int hires_mode(struct PPU *ppu)
+{
+	return ppu->BG_mode == 5 || ppu->BG_mode == 6;
+}
+
+static const struct layer_order *mode_order(struct PPU *ppu)
+{
+	switch(ppu->BG_mode)
+	{
+		case 0:
+			return mode0_order;
+		case 1:
+			return ppu->M1_BG3_priority ? mode1_BG3_order : mode1_order;
+		case 6:
+			return mode6_order;
+		case 7:
+			return ppu->M7_EXTBG ? mode7_EXTBG_order : mode7_order;
+		default:
+			return mode2_order;
+	}
+}
+
+static uint16_t direct_color(uint8_t index, uint8_t palette)
+{
+	uint16_t r = ((index & 0x07) << 2) | ((palette & 0x01) << 1);
+	uint16_t g = ((index & 0x38) >> 1) | (palette & 0x02);
+	uint16_t b = ((index & 0xC0) >> 3) | (palette & 0x04);
+
+	return r | (g << 5) | (b << 10);
+}
+
+static uint16_t tilemap_addr(struct PPU *ppu, int layer, int tile_x, int tile_y)
+{
+	uint16_t addr = (0x0000 | ppu->BGn_tilemap_info.tilemap_vram_addr[layer]) << 10;
+
+	addr += (tile_y & 31) * TILEMAP_BASE_SIDE + (tile_x & 31);
+
+	// 32x32 tilemaps are laid out left to right, then top to bottom
+	if((tile_x & 32) && ppu->BGn_tilemap_info.horizontal_tilemaps[layer] == 2)
+	{
+		addr += 0x0400;
+	}
+
+	if((tile_y & 32) && ppu->BGn_tilemap_info.vertical_tilemaps[layer] == 2)
+	{
+		addr += ppu->BGn_tilemap_info.horizontal_tilemaps[layer] == 2 ? 0x0800 : 0x0400;
+	}
+
+	return addr;
+}
+
+// planar to one byte per pixel for a single 8 pixel row, each word holds 2 bitplanes and the pairs are 8 words apart
+static void decode_row(struct data_bus *data_bus, uint16_t chr_addr, int bpp, uint8_t *row)
+{
+	memset(row, 0, 8);
+
+	for(int plane = 0; plane < bpp; plane += 2)
+	{
+		uint16_t bitplanes = read_VRAM(data_bus, (chr_addr + plane * 4) & VRAM_ADDR_MASK);
+
+		for(int i = 0; i < 8; i++)
+		{
+			row[i] |= ((bitplanes >> (7 - i)) & 0x01) << plane;
+			row[i] |= ((bitplanes >> (15 - i)) & 0x01) << (plane + 1);
+		}
+	}
+}
+
+void invalidate_tile(struct data_bus *data_bus, uint16_t addr)
+{
+	struct PPU_memory *memory = data_bus->B_bus.ppu->memory;
+
+	addr &= VRAM_ADDR_MASK;
+
+	memory->tile_dirty[0][addr >> 3] = 1;
+	memory->tile_dirty[1][addr >> 4] = 1;
+	memory->tile_dirty[2][addr >> 5] = 1;
+}
+
+static const uint8_t *decoded_tile(struct data_bus *data_bus, int bpp, uint16_t chr_addr)
+{
+	struct PPU_memory *memory = data_bus->B_bus.ppu->memory;
+
+	int view = bpp >> 2;
+	int shift = view + 3;
+	uint16_t character = (chr_addr & VRAM_ADDR_MASK) >> shift;
+	uint8_t *tile = &memory->tile_cache[view][character * TILE_PIXELS];
+
+	if(memory->tile_dirty[view][character])
+	{
+		for(int row = 0; row < 8; row++)
+		{
+			decode_row(data_bus, (character << shift) + row, bpp, &tile[row * 8]);
+		}
+
+		memory->tile_dirty[view][character] = 0;
+	}
+
+	return tile;
+}
+
+// modes 2, 4 and 6 replace the scroll of BG1/BG2 per tile column with entries from BG3's tilemap
+static void offset_per_tile(struct data_bus *data_bus, int layer, int column, uint16_t *hofs, uint16_t *vofs)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(column == 0)
+	{
+		return;
+	}
+
+	uint16_t enable = layer == 0 ? 0x2000 : 0x4000;
+	int tile_x = (column - 1) + ((ppu->BG_scroll_offset.BGn_horizontal_offset[2] & 0x03FF) >> 3);
+	int tile_y = (ppu->BG_scroll_offset.BGn_vertical_offset[2] & 0x03FF) >> 3;
+
+	uint16_t h_entry = read_VRAM(data_bus, tilemap_addr(ppu, 2, tile_x, tile_y) & VRAM_ADDR_MASK);
+	uint16_t v_entry;
+
+	if(ppu->BG_mode == 4)
+	{
+		// one entry, bit 15 picks which offset it replaces
+		v_entry = check_bit16(h_entry, 0x8000) ? h_entry : 0;
+		h_entry = check_bit16(h_entry, 0x8000) ? 0 : h_entry;
+	}
+	else 
+	{
+		v_entry = read_VRAM(data_bus, tilemap_addr(ppu, 2, tile_x, tile_y + 1) & VRAM_ADDR_MASK);
+	}
+
+	if(h_entry & enable)
+	{
+		*hofs = (*hofs & 0x0007) | (h_entry & 0x03F8);
+	}
+
+	if(v_entry & enable)
+	{
+		*vofs = v_entry & 0x03FF;
+	}
+}
+
+static void render_BG(struct data_bus *data_bus, int layer, int bpp, int scale, int start, int end)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	struct layer_pixels *pixels = &ppu->layer_pixels[layer];
+
+	// hi-res modes always use 16 pixel wide tiles
+	int tile_w = ppu->BGn_character_size[layer] == CH_SIZE_16x16 || scale == 2 ? 16 : 8;
+	int tile_h = ppu->BGn_character_size[layer] == CH_SIZE_16x16 ? 16 : 8;
+
+	uint16_t chr_base = (0x0000 | ppu->BGn_chr_tiles_offset[layer]) << 12;
+	uint16_t palette_base = ppu->BG_mode == 0 ? layer * 32 : 0;
+	int direct = bpp == 8 && ppu->direct_color;
+	int opt = (ppu->BG_mode == 2 || ppu->BG_mode == 4 || ppu->BG_mode == 6) && layer < 2;
+
+	int x = start;
+
+	while(x < end)
+	{
+		uint16_t hofs = ppu->BG_scroll_offset.BGn_horizontal_offset[layer] & 0x03FF;
+		uint16_t vofs = ppu->BG_scroll_offset.BGn_vertical_offset[layer] & 0x03FF;
+
+		if(opt)
+		{
+			offset_per_tile(data_bus, layer, ((x / scale) + (hofs & 7)) >> 3, &hofs, &vofs);
+		}
+
+		uint32_t screen_x = x + hofs * scale;
+		uint32_t screen_y = ppu->render_line + 1 + vofs;
+
+		struct tilemap tile;
+		get_tile(&tile, data_bus, tilemap_addr(ppu, layer, screen_x / tile_w, screen_y / tile_h));
+
+		uint16_t character = tile.character;
+		int fine_y = screen_y & 7;
+
+		if(tile_w == 16 && ((screen_x & 8) != 0) != tile.flip_horizontal)
+		{
+			character += 1;
+		}
+
+		if(tile_h == 16 && ((screen_y & 8) != 0) != tile.flip_vertical)
+		{
+			character += TILESET_ROW_SIZE;
+		}
+
+		if(tile.flip_vertical)
+		{
+			fine_y = 7 - fine_y;
+		}
+
+		const uint8_t *row = decoded_tile(data_bus, bpp, chr_base + (character & 0x03FF) * bpp * 4) + fine_y * 8;
+
+		uint16_t palette = palette_base + (bpp == 8 ? 0 : tile.palette << bpp);
+
+		for(int fine_x = screen_x & 7; fine_x < 8 && x < end; fine_x++, x++)
+		{
+			uint8_t index = row[tile.flip_horizontal ? 7 - fine_x : fine_x];
+
+			if(index == 0)
+			{
+				pixels->priority[x] = 0;
+
+				continue;
+			}
+
+			pixels->color[x] = direct ? direct_color(index, tile.palette) : read_CGRAM(data_bus, palette + index);
+			pixels->priority[x] = tile.priority + 1;
+		}
+	}
+}
+
+static void sprite_size(enum sprite_sizes size, int *width, int *height)
+{
+	switch(size)
+	{
+		case S_8x8:
+			*width = 8;
+			*height = 8;
+
+			break;
+		case S_16x16:
+			*width = 16;
+			*height = 16;
+
+			break;
+		case S_32x32:
+			*width = 32;
+			*height = 32;
+
+			break;
+		case S_64x64:
+			*width = 64;
+			*height = 64;
+
+			break;
+		case S_16x32:
+			*width = 16;
+			*height = 32;
+
+			break;
+		case S_32x64:
+			*width = 32;
+			*height = 64;
+
+			break;
+	}
+}
+
+struct sprite
+{
+	int x;
+	uint8_t y;
+	uint16_t character;
+	uint8_t palette;
+	uint8_t priority;
+	int flip_vertical;
+	int flip_horizontal;
+	int width;
+	int height;
+};
+
+static void get_sprite(struct sprite *sprite, struct data_bus *data_bus, int n)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	uint8_t attributes = read_OAM(data_bus, n * 4 + 3);
+	uint8_t high_bits = read_OAM(data_bus, 0x0200 + n / 4) >> ((n % 4) * 2);
+
+	// 9-bit signed
+	sprite->x = read_OAM(data_bus, n * 4) | ((high_bits & 0x01) << 8);
+	sprite->x = sprite->x >= 256 ? sprite->x - 512 : sprite->x;
+	sprite->y = read_OAM(data_bus, n * 4 + 1);
+	sprite->character = read_OAM(data_bus, n * 4 + 2) | ((attributes & 0x01) << 8);
+	sprite->palette = (attributes & 0b00001110) >> 1;
+	sprite->priority = (attributes & 0b00110000) >> 4;
+	sprite->flip_horizontal = check_bit8(attributes, 0x40);
+	sprite->flip_vertical = check_bit8(attributes, 0x80);
+
+	sprite_size(ppu->obj_sizes[(high_bits & 0x02) >> 1], &sprite->width, &sprite->height);
+}
+
+static void build_sprite_index(struct data_bus *data_bus)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	memset(ppu->line_sprite_count, 0, sizeof(ppu->line_sprite_count));
+
+	for(int n = 0; n < OAM_SPRITES; n++)
+	{
+		struct sprite sprite;
+		get_sprite(&sprite, data_bus, n);
+
+		for(int row = 0; row < sprite.height; row++)
+		{
+			int line = (sprite.y + row) % SPRITE_LINES;
+
+			ppu->line_sprites[line][ppu->line_sprite_count[line]++] = n;
+		}
+	}
+
+	ppu->OAM_dirty = 0;
+}
+
+static void draw_sprite_tile(struct data_bus *data_bus, struct sprite *sprite, uint16_t character, int x, int fine_y)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	struct layer_pixels *pixels = &ppu->layer_pixels[OBJ_LAYER];
+
+	uint16_t chr_addr = (0x0000 | ppu->name_base_addr) << 13;
+
+	if(character & 0x0100)
+	{
+		chr_addr += (ppu->name_select + 1) << 12;
+	}
+
+	const uint8_t *row = decoded_tile(data_bus, 4, chr_addr + (character & 0x00FF) * 16) + fine_y * 8;
+
+	for(int fine_x = 0; fine_x < 8; fine_x++)
+	{
+		uint8_t index = row[sprite->flip_horizontal ? 7 - fine_x : fine_x];
+
+		if(x + fine_x < 0 || x + fine_x >= LINE_PIXELS || index == 0)
+		{
+			continue;
+		}
+
+		pixels->color[x + fine_x] = read_CGRAM(data_bus, 128 + (sprite->palette * 16) + index);
+		pixels->priority[x + fine_x] = sprite->priority + 1;
+
+		// palettes 0-3 never take part in color math
+		if(sprite->palette < 4)
+		{
+			pixels->priority[x + fine_x] |= NO_COLOR_MATH;
+		}
+	}
+}
+
+// range over: more than 32 sprites on the line, time over: more than 34 tiles
+static void render_sprites(struct data_bus *data_bus)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	int line = ppu->render_line % SPRITE_LINES;
+
+	memset(ppu->layer_pixels[OBJ_LAYER].priority, 0, LINE_PIXELS);
+
+	if(ppu->OAM_dirty)
+	{
+		build_sprite_index(data_bus);
+	}
+
+	struct sprite sprites[LINE_SPRITES];
+	int count = 0;
+
+	// the list is in OAM order, starting from the first sprite picked by priority rotation
+	for(int pass = 0; pass < 2; pass++)
+	{
+		for(int i = 0; i < ppu->line_sprite_count[line]; i++)
+		{
+			int n = ppu->line_sprites[line][i];
+
+			if((n >= ppu->first_sprite) != (pass == 0))
+			{
+				continue;
+			}
+
+			struct sprite sprite;
+			get_sprite(&sprite, data_bus, n);
+
+			if(sprite.x <= -sprite.width || sprite.x >= LINE_PIXELS)
+			{
+				continue;
+			}
+
+			if(count == LINE_SPRITES)
+			{
+				ppu->range_over = 1;
+
+				break;
+			}
+
+			sprites[count++] = sprite;
+		}
+	}
+
+	// tiles are fetched from the last sprite backwards, and lower OAM indices are drawn on top
+	int tiles = 0;
+
+	for(int i = count - 1; i >= 0; i--)
+	{
+		struct sprite *sprite = &sprites[i];
+		int row = (line - sprite->y) & 0xFF;
+
+		if(sprite->flip_vertical)
+		{
+			row = sprite->height - 1 - row;
+		}
+
+		for(int column = 0; column < sprite->width / 8; column++)
+		{
+			int x = sprite->x + column * 8;
+
+			if(x <= -8 || x >= LINE_PIXELS)
+			{
+				continue;
+			}
+
+			if(tiles == LINE_TILES)
+			{
+				ppu->time_over = 1;
+
+				return;
+			}
+
+			tiles++;
+
+			int tile_column = sprite->flip_horizontal ? sprite->width / 8 - 1 - column : column;
+			uint16_t character = sprite->character & 0x0100;
+			character |= (((sprite->character >> 4) + row / 8) & 0x0F) << 4;
+			character |= (sprite->character + tile_column) & 0x0F;
+
+			draw_sprite_tile(data_bus, sprite, character, x, row & 7);
+		}
+	}
+}
+
+static int M7_sign_extend(uint16_t value)
+{
+	// 13-bit signed
+	return check_bit16(value, 0x1000) ? (int)value | ~0x1FFF : value & 0x1FFF;
+}
+
+static int M7_clip(int value)
+{
+	return (value & 0x2000) ? (value | ~0x03FF) : (value & 0x03FF);
+}
+
+static void render_M7(struct data_bus *data_bus, int start, int end)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	struct layer_pixels *BG1 = &ppu->layer_pixels[0];
+	struct layer_pixels *BG2 = &ppu->layer_pixels[1];
+
+	int a = (int16_t)ppu->M7_matrices.A;
+	int b = (int16_t)ppu->M7_matrices.B;
+	int c = (int16_t)ppu->M7_matrices.C;
+	int d = (int16_t)ppu->M7_matrices.D;
+
+	int center_x = M7_sign_extend(ppu->M7_matrices.center_X);
+	int center_y = M7_sign_extend(ppu->M7_matrices.center_Y);
+	int hofs = M7_clip(M7_sign_extend(ppu->M7_matrices.horizontal_offset) - center_x);
+	int vofs = M7_clip(M7_sign_extend(ppu->M7_matrices.vertical_offset) - center_y);
+
+	int y = ppu->render_line + 1;
+
+	if(ppu->flip_BG_vertical)
+	{
+		y = 255 - y;
+	}
+
+	// the hardware drops the low 6 bits of every product
+	int origin_x = ((a * hofs) & ~63) + ((b * vofs) & ~63) + ((b * y) & ~63) + (center_x * 256);
+	int origin_y = ((c * hofs) & ~63) + ((d * vofs) & ~63) + ((d * y) & ~63) + (center_y * 256);
+
+	for(int x = start; x < end; x++)
+	{
+		int screen_x = ppu->flip_BG_horizontal ? 255 - x : x;
+		int px = (origin_x + a * screen_x) >> 8;
+		int py = (origin_y + c * screen_x) >> 8;
+
+		uint8_t tile = 0;
+
+		if(((px | py) & ~0x03FF) && ppu->tilemap_repeat)
+		{
+			if(!ppu->non_tilemap_fill)
+			{
+				BG1->priority[x] = 0;
+				BG2->priority[x] = 0;
+
+				continue;
+			}
+		}
+		else 
+		{
+			tile = LE_LBYTE16(read_VRAM(data_bus, ((py >> 3) & 127) * 128 + ((px >> 3) & 127)));
+		}
+
+		uint8_t index = LE_HBYTE16(read_VRAM(data_bus, tile * 64 + (py & 7) * 8 + (px & 7)));
+
+		BG1->priority[x] = index ? 1 : 0;
+		BG1->color[x] = ppu->direct_color ? direct_color(index, 0) : read_CGRAM(data_bus, index);
+
+		// EXTBG, bit 7 is the priority
+		BG2->priority[x] = (index & 0x7F) ? (index >> 7) + 1 : 0;
+		BG2->color[x] = read_CGRAM(data_bus, index & 0x7F);
+	}
+}
+
+struct screen
+{
+	uint16_t color[VISIBLE_DOTS];
+	uint8_t layer[VISIBLE_DOTS]; // BG1-4, OBJ_LAYER or BACKDROP_LAYER, plus NO_COLOR_MATH
+};
+
+static void build_window(struct PPU *ppu, uint8_t *window, int target, int shift, int start, int end)
+{
+	int enable_1, invert_1, enable_2, invert_2;
+	enum window_mask mask;
+
+	if(target < BG_LAYERS)
+	{
+		enable_1 = ppu->window_select.enable_BGn_window_1[target];
+		invert_1 = ppu->window_select.invert_BGn_window_1[target];
+		enable_2 = ppu->window_select.enable_BGn_window_2[target];
+		invert_2 = ppu->window_select.invert_BGn_window_2[target];
+		mask = ppu->BGn_window_mask[target];
+	}
+	else if(target == OBJ_LAYER)
+	{
+		enable_1 = ppu->window_select.enable_OBJ_window_1;
+		invert_1 = ppu->window_select.invert_OBJ_window_1;
+		enable_2 = ppu->window_select.enable_OBJ_window_2;
+		invert_2 = ppu->window_select.invert_OBJ_window_2;
+		mask = ppu->OBJ_window_mask;
+	}
+	else 
+	{
+		enable_1 = ppu->window_select.enable_color_window_1;
+		invert_1 = ppu->window_select.invert_color_window_1;
+		enable_2 = ppu->window_select.enable_color_window_2;
+		invert_2 = ppu->window_select.invert_color_window_2;
+		mask = ppu->Color_window_mask;
+	}
+
+	if(!enable_1 && !enable_2)
+	{
+		memset(&window[start], 0, end - start);
+
+		return;
+	}
+
+	for(int x = start; x < end; x++)
+	{
+		int pixel = x >> shift;
+		int w1 = (ppu->window_position.W1_left <= pixel && pixel <= ppu->window_position.W1_right) != invert_1;
+		int w2 = (ppu->window_position.W2_left <= pixel && pixel <= ppu->window_position.W2_right) != invert_2;
+
+		if(!enable_2)
+		{
+			window[x] = w1;
+		}
+		else if(!enable_1)
+		{
+			window[x] = w2;
+		}
+		else 
+		{
+			switch(mask)
+			{
+				case OR_mask:
+					window[x] = w1 | w2;
+
+					break;
+				case AND_mask:
+					window[x] = w1 & w2;
+
+					break;
+				case XOR_mask:
+					window[x] = w1 ^ w2;
+
+					break;
+				case XNOR_mask:
+					window[x] = !(w1 ^ w2);
+
+					break;
+			}
+		}
+	}
+}
+
+static int in_region(enum window_regions region, int inside)
+{
+	switch(region)
+	{
+		case Nowhere:
+			return 0;
+		case Outside:
+			return !inside;
+		case Inside:
+			return inside;
+		default:
+			return 1;
+	}
+}
+
+static int layer_color_math(struct PPU *ppu, uint8_t layer)
+{
+	if(layer & NO_COLOR_MATH)
+	{
+		return 0;
+	}
+
+	if(layer == OBJ_LAYER)
+	{
+		return ppu->obj_color_math;
+	}
+
+	if(layer == BACKDROP_LAYER)
+	{
+		return ppu->backdrop_color_math;
+	}
+
+	return ppu->BGn_color_math[layer];
+}
+
+static void paint_screen(struct PPU *ppu, struct screen *screen, int enabled, int windowed, uint8_t windows[][VISIBLE_DOTS], uint16_t backdrop, int scale, int start, int end)
+{
+	for(int x = start; x < end; x++)
+	{
+		screen->color[x] = backdrop;
+		screen->layer[x] = BACKDROP_LAYER;
+	}
+
+	for(const struct layer_order *order = mode_order(ppu); order->layer >= 0; order++)
+	{
+		if(!(enabled & (1 << order->layer)))
+		{
+			continue;
+		}
+
+		struct layer_pixels *pixels = &ppu->layer_pixels[order->layer];
+		uint8_t *window = windows[order->layer];
+		int masked = windowed & (1 << order->layer);
+
+		// sprites stay 256 pixels wide in hi-res modes
+		int shift = order->layer == OBJ_LAYER && scale == 2 ? 1 : 0;
+
+		for(int x = start; x < end; x++)
+		{
+			uint8_t priority = pixels->priority[x >> shift];
+
+			if((priority & ~NO_COLOR_MATH) != order->priority + 1 || (masked && window[x]))
+			{
+				continue;
+			}
+
+			screen->color[x] = pixels->color[x >> shift];
+			screen->layer[x] = order->layer | (priority & NO_COLOR_MATH);
+		}
+	}
+}
+
+static int screen_layers(int OBJ, int *BGn)
+{
+	return (OBJ << OBJ_LAYER) | (BGn[3] << 3) | (BGn[2] << 2) | (BGn[1] << 1) | BGn[0];
+}
+
+// x * 4370 >> 16 is x / 15 rounded down for every x <= 31 * 15
+#define DIV15_MULTIPLIER 4370
+
+static void build_host_colors(struct PPU *ppu)
+{
+	uint32_t channel[32];
+
+	for(int c = 0; c < 32; c++)
+	{
+		// INIDISP brightness scales every channel by brightness / 15
+		channel[c] = ((c * ppu->brightness * DIV15_MULTIPLIER) >> 16) << 3;
+	}
+
+	for(int color = 0; color < BGR555_COLORS; color++)
+	{
+		ppu->host_colors[color] = channel[color & 0x1F] << HOST_RED_SHIFT;
+		ppu->host_colors[color] |= channel[(color >> 5) & 0x1F] << HOST_GREEN_SHIFT;
+		ppu->host_colors[color] |= channel[(color >> 10) & 0x1F] << HOST_BLUE_SHIFT;
+	}
+
+	ppu->host_brightness = ppu->brightness;
+}
+
+static void composite(struct data_bus *data_bus, int main_enabled, int sub_enabled, int scale, int start, int end)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	struct screen main;
+	struct screen sub;
+	uint8_t windows[COLOR_WINDOW + 1][VISIBLE_DOTS];
+	uint16_t math_flags[VISIBLE_DOTS];
+	uint16_t colors[VISIBLE_DOTS];
+
+	for(int target = 0; target <= COLOR_WINDOW; target++)
+	{
+		build_window(ppu, windows[target], target, scale == 2 ? 1 : 0, start, end);
+	}
+
+	paint_screen(ppu, &main, main_enabled, screen_layers(ppu->apply_window_OBJ_main, ppu->apply_window_BGn_main), windows, read_CGRAM(data_bus, 0), scale, start, end);
+
+	// the sub screen's backdrop is the fixed color
+	uint16_t fixed_color = ppu->fixed_red | (ppu->fixed_green << 5) | (ppu->fixed_blue << 10);
+
+	paint_screen(ppu, &sub, ppu->addend ? sub_enabled : 0, screen_layers(ppu->apply_window_OBJ_sub, ppu->apply_window_BGn_sub), windows, fixed_color, scale, start, end);
+
+	for(int x = start; x < end; x++)
+	{
+		int inside = windows[COLOR_WINDOW][x];
+		int black = in_region(ppu->mainscreen_black_region, inside);
+		int math = layer_color_math(ppu, main.layer[x]) && !in_region(ppu->subscreen_transparent_region, inside);
+
+		// no halving against a transparent sub screen or a clipped main screen
+		int half = ppu->half_color_math && !black && !(ppu->addend && sub.layer[x] == BACKDROP_LAYER);
+
+		if(black)
+		{
+			main.color[x] = 0;
+		}
+
+		math_flags[x] = math ? COLOR_MATH_ENABLE | (half ? COLOR_MATH_HALF : 0) : 0;
+	}
+
+	color_math(&colors[start], &main.color[start], &sub.color[start], &math_flags[start], ppu->operator, end - start);
+
+	if(ppu->host_brightness != ppu->brightness)
+	{
+		build_host_colors(ppu);
+	}
+
+	for(int x = start; x < end; x++)
+	{
+		ppu->line_buffer[x] = ppu->host_colors[colors[x] & 0x7FFF];
+	}
+}
+
+static void render_segment(struct data_bus *data_bus, int start, int end)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(ppu->F_blank)
+	{
+		int scale = ppu->line_hires ? 2 : 1;
+
+		memset(&ppu->line_buffer[start * scale], 0, (end - start) * scale * sizeof(uint32_t));
+
+		return;
+	}
+
+	int scale = ppu->line_hires ? 2 : 1;
+	int main_enabled = screen_layers(ppu->OBJ_main_enable, ppu->BGn_main_enable);
+	int sub_enabled = screen_layers(ppu->OBJ_sub_enable, ppu->BGn_sub_enable);
+
+	// BGs are rendered once and shared by both screens
+	int enabled = main_enabled | (ppu->addend ? sub_enabled : 0);
+
+	if(ppu->BG_mode == 7)
+	{
+		if((enabled & 0x01) || (ppu->M7_EXTBG && (enabled & 0x02)))
+		{
+			render_M7(data_bus, start, end);
+		}
+
+		if(!ppu->M7_EXTBG)
+		{
+			main_enabled &= ~0x02;
+			sub_enabled &= ~0x02;
+		}
+
+		main_enabled &= ~0x0C;
+		sub_enabled &= ~0x0C;
+	}
+	else 
+	{
+		for(int layer = 0; layer < BG_LAYERS; layer++)
+		{
+			int bpp = mode_bpp[ppu->BG_mode][layer];
+
+			if(bpp && (enabled & (1 << layer)))
+			{
+				render_BG(data_bus, layer, bpp, scale, start * scale, end * scale);
+			}
+			else if(!bpp)
+			{
+				main_enabled &= ~(1 << layer);
+				sub_enabled &= ~(1 << layer);
+			}
+		}
+	}
+
+	composite(data_bus, main_enabled, sub_enabled, scale, start * scale, end * scale);
+}
+
+void start_line(struct data_bus *data_bus)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	ppu->render_x = 0;
+	ppu->render_line = (ppu->y - HIDE_LINES) / 2;
+
+	// hi-res is latched for the whole line so the line buffer has one width
+	ppu->line_hires = hires_mode(ppu);
+
+	if(!visible_line(ppu))
+	{
+		return;
+	}
+
+	if(ppu->F_blank)
+	{
+		memset(ppu->layer_pixels[OBJ_LAYER].priority, 0, LINE_PIXELS);
+	}
+	else 
+	{
+		render_sprites(data_bus);
+	}
+}
+
+void flush_line(struct data_bus *data_bus)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(!visible_line(ppu) || data_bus->B_bus.ppu->skip_render)
+	{
+		return;
+	}
+
+	int end = beam_pixel(ppu);
+
+	if(ppu->render_x < end)
+	{
+		render_segment(data_bus, ppu->render_x, end);
+
+		ppu->render_x = end;
+	}
+}
+
+static int frame_row(struct PPU *ppu)
+{
+	if(ppu->screen_interlacing)
+	{
+		return ppu->render_line * 2 + (ppu->interlace_field & 0x01);
+	}
+
+	return ppu->render_line;
+}
+
+void finish_line(struct data_bus *data_bus)
+{
+	struct S_PPU *s_ppu = data_bus->B_bus.ppu;
+	struct PPU *ppu = s_ppu->ppu;
+
+	if(!visible_line(ppu) || s_ppu->skip_render)
+	{
+		return;
+	}
+
+	if(ppu->render_x < LINE_PIXELS)
+	{
+		render_segment(data_bus, ppu->render_x, LINE_PIXELS);
+
+		ppu->render_x = LINE_PIXELS;
+	}
+
+	int row = frame_row(ppu);
+	int width = ppu->line_hires ? VISIBLE_DOTS : LINE_PIXELS;
+
+	memcpy(&s_ppu->frame_buffer[row * FRAME_MAX_WIDTH], ppu->line_buffer, width * sizeof(uint32_t));
+
+	s_ppu->frame_line_hires[row] = ppu->line_hires;
+	s_ppu->frame_hires |= ppu->line_hires;
+}
+
+void finish_frame(struct data_bus *data_bus)
+{
+	struct S_PPU *s_ppu = data_bus->B_bus.ppu;
+	struct PPU *ppu = s_ppu->ppu;
+
+	s_ppu->frame_height = ppu->overscan ? FRAME_OVERSCAN_LINES : FRAME_LINES;
+
+	if(ppu->screen_interlacing)
+	{
+		s_ppu->frame_height *= 2;
+	}
+
+	s_ppu->frame_width = s_ppu->frame_hires ? VISIBLE_DOTS : LINE_PIXELS;
+
+	// a frame with any hi-res line is 512 wide, so the 256 pixel lines get doubled in place
+	// doubled rows are marked, so the field an interlaced frame didn't redraw isn't doubled twice
+	for(int row = 0; s_ppu->frame_hires && row < s_ppu->frame_height; row++)
+	{
+		uint32_t *pixels = &s_ppu->frame_buffer[row * FRAME_MAX_WIDTH];
+
+		if(s_ppu->frame_line_hires[row])
+		{
+			continue;
+		}
+
+		for(int x = LINE_PIXELS - 1; x >= 0; x--)
+		{
+			pixels[x * 2 + 1] = pixels[x];
+			pixels[x * 2] = pixels[x];
+		}
+
+		s_ppu->frame_line_hires[row] = 1;
+	}
+
+	s_ppu->frame_hires = 0;
+}
+
+// first master cycle a dot reads VRAM, CGRAM or OAM for the picture, capped at limit
+// writes to PPU memory before then can't be told apart from writes made all at once
+uint64_t render_horizon(struct data_bus *data_bus, uint64_t limit)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	uint64_t cycle = data_bus->scheduler->ppu_clock;
+	int x = ppu->x;
+	int y = ppu->y;
+
+	if(ppu->F_blank)
+	{
+		return limit;
+	}
+
+	// start_line to finish_line of a visible line
+	while(cycle < limit && !(visible_y(ppu, y) && HIDE_DOTS <= x && x <= HIDE_DOTS + VISIBLE_DOTS))
+	{
+		cycle += dot_cycles(x, y);
+		advance_beam(&x, &y);
+	}
+
+	return cycle < limit ? cycle : limit;
+}
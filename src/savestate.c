@@ -0,0 +1,286 @@
+#include "savestate.h"
+#include "memory.h"
+#include "ricoh5A22.h"
+#include "PPU.h"
+#include "DMA.h"
+#include "scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define REG_STATE_BYTES ((REG_BYTES[1] + 1) - REG_BYTES[0]) // only the first bank is ever written, the rest fold onto it
+
+// one walk over every section, counting, saving or loading depending on which buffer is set
+struct state_stream
+{
+	uint8_t *save;
+	const uint8_t *load;
+	size_t offset;
+	size_t size;
+};
+
+static void state_section(struct state_stream *stream, void *data, size_t bytes)
+{
+	if(stream->offset + bytes <= stream->size)
+	{
+		if(stream->save)
+		{
+			memcpy(stream->save + stream->offset, data, bytes);
+		}
+		else if(stream->load)
+		{
+			memcpy(data, stream->load + stream->offset, bytes);
+		}
+	}
+
+	stream->offset += bytes;
+}
+
+static uint8_t *SRAM(struct Memory *memory, size_t *bytes)
+{
+	switch(memory->ROM_type_marker)
+	{
+		case LoROM_MARKER:
+			*bytes = LoROM_SRAM_SIZE;
+
+			return memory->ROM.LoROM.SRAM;
+		case HiROM_MARKER:
+			*bytes = HiROM_SRAM_SIZE;
+
+			return memory->ROM.HiROM.SRAM;
+		case ExHiROM_MARKER:
+			*bytes = ExHiROM_SRAM_SIZE;
+
+			return memory->ROM.ExHiROM.SRAM;
+		default:
+			*bytes = 0;
+
+			return NULL;
+	}
+}
+
+static void state_sections(struct state_stream *stream, struct data_bus *data_bus)
+{
+	struct Memory *memory = data_bus->A_Bus.memory;
+	struct PPU_memory *ppu_memory = data_bus->B_bus.ppu->memory;
+
+	size_t SRAM_bytes = 0;
+	uint8_t *SRAM_data = SRAM(memory, &SRAM_bytes);
+
+	state_section(stream, data_bus->A_Bus.cpu, sizeof(struct Ricoh_5A22));
+	state_section(stream, data_bus->B_bus.ppu->ppu, sizeof(struct PPU));
+	state_section(stream, data_bus->B_bus.dma, sizeof(struct DMA));
+	state_section(stream, data_bus->scheduler, sizeof(struct Scheduler));
+	state_section(stream, &data_bus->open_value, sizeof(data_bus->open_value));
+
+	state_section(stream, &memory->WRAM_addr, sizeof(memory->WRAM_addr));
+	state_section(stream, memory->WRAM, WRAM_SIZE);
+	state_section(stream, memory->REG, REG_STATE_BYTES);
+	state_section(stream, SRAM_data, SRAM_bytes);
+
+	state_section(stream, ppu_memory->VRAM, VRAM_WORDS * VRAM_WORD_WIDTH);
+	state_section(stream, ppu_memory->OAM_low_table, OAM_LTABLE_BYTES);
+	state_section(stream, ppu_memory->OAM_high_table, OAM_HTABLE_BYTES);
+	state_section(stream, ppu_memory->CGRAM, CGRAM_WORDS * 2);
+}
+
+// FNV-1a over the cartridge image, two carts can share a layout, size and even the internal checksum
+static uint64_t ROM_hash(struct Memory *memory)
+{
+	uint8_t *ROM = NULL;
+	uint64_t hash = 0xCBF29CE484222325;
+
+	if(memory->ROM_type_marker == LoROM_MARKER)
+	{
+		ROM = memory->ROM.LoROM.ROM;
+	}
+	else if(memory->ROM_type_marker == HiROM_MARKER)
+	{
+		ROM = memory->ROM.HiROM.ROM;
+	}
+	else if(memory->ROM_type_marker == ExHiROM_MARKER)
+	{
+		ROM = memory->ROM.ExHiROM.ROM;
+	}
+
+	for(uint32_t i = 0; ROM && i < memory->ROM_size; i++)
+	{
+		hash ^= ROM[i];
+		hash *= 0x00000100000001B3;
+	}
+
+	return hash;
+}
+
+static void state_header(struct data_bus *data_bus, struct save_state_header *header, size_t size)
+{
+	memset(header, 0, sizeof(struct save_state_header));
+
+	header->magic = SAVE_STATE_MAGIC;
+	header->version = SAVE_STATE_VERSION;
+	header->size = size;
+
+	header->ROM_type_marker = data_bus->A_Bus.memory->ROM_type_marker;
+	header->ROM_size = data_bus->A_Bus.memory->ROM_size;
+	header->ROM_hash = ROM_hash(data_bus->A_Bus.memory);
+
+	header->cpu_bytes = sizeof(struct Ricoh_5A22);
+	header->ppu_bytes = sizeof(struct PPU);
+	header->dma_bytes = sizeof(struct DMA);
+	header->scheduler_bytes = sizeof(struct Scheduler);
+}
+
+size_t save_state_size(struct data_bus *data_bus)
+{
+	struct state_stream stream = { NULL, NULL, sizeof(struct save_state_header), 0 };
+
+	state_sections(&stream, data_bus);
+
+	return stream.offset;
+}
+
+// returns the bytes written, 0 if buffer is too small
+size_t save_state(struct data_bus *data_bus, uint8_t *buffer, size_t size)
+{
+	size_t state_size = save_state_size(data_bus);
+	struct state_stream stream = { buffer, NULL, sizeof(struct save_state_header), size };
+	struct save_state_header header;
+
+	if(size < state_size)
+	{
+		return 0;
+	}
+
+	state_header(data_bus, &header, state_size);
+	memcpy(buffer, &header, sizeof(struct save_state_header));
+
+	state_sections(&stream, data_bus);
+
+	return state_size;
+}
+
+int load_state(struct data_bus *data_bus, const uint8_t *buffer, size_t size)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+	struct PPU_memory *ppu_memory = data_bus->B_bus.ppu->memory;
+	struct DMA *dma = data_bus->B_bus.dma;
+
+	struct save_state_header expected;
+	struct save_state_header header;
+
+	if(size < sizeof(struct save_state_header))
+	{
+		printf("Failed load: state is too short\n");
+
+		return 0;
+	}
+
+	memcpy(&header, buffer, sizeof(struct save_state_header));
+	state_header(data_bus, &expected, save_state_size(data_bus));
+
+	if(memcmp(&header, &expected, sizeof(struct save_state_header)) != 0 || size < header.size)
+	{
+		printf("Failed load: state is from another version, build or cartridge\n");
+
+		return 0;
+	}
+
+	// host pointers stay with this process
+	struct decoded_instruction *decode_cache = cpu->decode_cache;
+	uint32_t *host_colors = ppu->host_colors;
+	struct HDMA_line *HDMA_program[N_CHANNELS];
+
+	memcpy(HDMA_program, dma->HDMA_program, sizeof(HDMA_program));
+
+	struct state_stream stream = { NULL, buffer, sizeof(struct save_state_header), size };
+
+	state_sections(&stream, data_bus);
+
+	// MEMSEL only remaps on a change, the state's ROM speed has to be put in place here
+	map_access_cycles(data_bus->A_Bus.memory, cpu->internal_registers.fast_ROM);
+
+	cpu->decode_cache = decode_cache;
+	swap_cpu_status(cpu, cpu->cpu_status);
+	flush_decode_cache(cpu);
+
+	ppu->host_colors = host_colors;
+	ppu->host_brightness = -1;
+	ppu->OAM_dirty = 1;
+
+	for(int i = 0; i < CGRAM_WORDS; i++)
+	{
+		ppu_memory->palette[i] = ppu_memory->CGRAM[i * 2] | (ppu_memory->CGRAM[i * 2 + 1] << 8);
+	}
+
+	for(int view = 0; view < TILE_CACHE_VIEWS; view++)
+	{
+		memset(ppu_memory->tile_dirty[view], 1, VRAM_WORDS >> (view + 3));
+	}
+
+	memcpy(dma->HDMA_program, HDMA_program, sizeof(HDMA_program));
+
+	for(int i = 0; i < N_CHANNELS; i++)
+	{
+		dma->HDMA_program_end[i] = 0;
+		dma->HDMA_page_count[i] = 0;
+	}
+
+	return 1;
+}
+
+int save_state_file(struct data_bus *data_bus, const char *filename)
+{
+	size_t size = save_state_size(data_bus);
+	uint8_t *buffer = malloc(size);
+	FILE *file = fopen(filename, "wb");
+	int saved = 0;
+
+	if(buffer && file)
+	{
+		save_state(data_bus, buffer, size);
+		saved = fwrite(buffer, 1, size, file) == size;
+	}
+
+	if(!saved)
+	{
+		printf("Failed save: %s\n", filename);
+	}
+
+	if(file)
+	{
+		fclose(file);
+	}
+
+	free(buffer);
+
+	return saved;
+}
+
+int load_state_file(struct data_bus *data_bus, const char *filename)
+{
+	size_t size = save_state_size(data_bus);
+	uint8_t *buffer = malloc(size);
+	FILE *file = fopen(filename, "rb");
+	int loaded = 0;
+
+	if(buffer && file && fread(buffer, 1, size, file) == size)
+	{
+		loaded = load_state(data_bus, buffer, size);
+	}
+	else 
+	{
+		printf("Failed load: %s\n", filename);
+	}
+
+	if(file)
+	{
+		fclose(file);
+	}
+
+	free(buffer);
+
+	return loaded;
+}
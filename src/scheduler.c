@@ -0,0 +1,318 @@
+#include "scheduler.h"
+#include "memory.h"
+#include "ricoh5A22.h"
+#include "PPU.h"
+#include "DMA.h"
+#include "utility.h"
+
+#include <stdint.h>
+#include <string.h>
+
+void init_scheduler(struct data_bus *data_bus)
+{
+	data_bus->scheduler->master_clock = 0;
+	data_bus->scheduler->ppu_clock = 0;
+	data_bus->scheduler->line_clock = 0;
+	data_bus->scheduler->IRQ_clock = NO_DEADLINE;
+	data_bus->scheduler->event_clock = 0;
+}
+
+uint64_t current_master_cycle(struct data_bus *data_bus)
+{
+	return data_bus->scheduler->master_clock + data_bus->A_Bus.cpu->queued_cyles;
+}
+
+static uint64_t next_event_cycle(struct data_bus *data_bus)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	return scheduler->line_clock + dot_offset(next_event_dot(data_bus), ppu->y);
+}
+
+// master cycle the H/V timer next matches the beam, looking from dot first of the beam's line on
+static uint64_t next_IRQ_cycle(struct data_bus *data_bus, int first)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	uint64_t line_clock = data_bus->scheduler->line_clock;
+	int y = ppu->y;
+	int x;
+
+	int IRQEN = cpu->internal_registers.IRQEN;
+	int V_target = cpu->internal_registers.vertical_IRQ_target;
+
+	switch(IRQEN)
+	{
+		case ENABLEHTIME:
+		case ENABLEHVTIME:
+			x = cpu->internal_registers.horizontal_IRQ_target;
+
+			break;
+		case ENABLEVTIME:
+			x = 0;
+
+			break;
+		default:
+			return NO_DEADLINE;
+	}
+
+	// the targets are compared against the beam, which only stops on even dots and lines
+	if((x & 1) || x > DOTS)
+	{
+		return NO_DEADLINE;
+	}
+
+	if(IRQEN != ENABLEHTIME && ((V_target & 1) || V_target > LINES + 1))
+	{
+		return NO_DEADLINE;
+	}
+
+	// every line comes around within a frame
+	for(int line = 0; line <= (LINES + 1) / 2 + 1; line++)
+	{
+		if(first <= x && (IRQEN == ENABLEHTIME || y == V_target))
+		{
+			return line_clock + dot_offset(x, y);
+		}
+
+		line_clock += line_cycles(y);
+		y = y >= LINES ? 0 : y + 2;
+		first = 0;
+	}
+
+	return NO_DEADLINE;
+}
+
+static void update_event_clock(struct data_bus *data_bus)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+	uint64_t beam_event = next_event_cycle(data_bus);
+
+	scheduler->event_clock = beam_event < scheduler->IRQ_clock ? beam_event : scheduler->IRQ_clock;
+}
+
+// the timer is only worked out again when NMITIMEN, HTIME or VTIME change, or when it fires
+void schedule_IRQ(struct data_bus *data_bus)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+
+	scheduler->IRQ_clock = next_IRQ_cycle(data_bus, data_bus->B_bus.ppu->ppu->x);
+
+	update_event_clock(data_bus);
+}
+
+// runs every PPU and timer event due before target, the beam is then placed from the clock
+void sync_PPU(struct data_bus *data_bus, uint64_t target)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	if(target <= scheduler->ppu_clock)
+	{
+		return;
+	}
+
+	while(1)
+	{
+		uint64_t cycle = next_event_cycle(data_bus);
+
+		// the timer goes first on a dot it shares with the beam
+		if(scheduler->IRQ_clock <= cycle && scheduler->IRQ_clock < target)
+		{
+			ppu->x = offset_dot(scheduler->IRQ_clock - scheduler->line_clock, ppu->y);
+			scheduler->ppu_clock = scheduler->IRQ_clock;
+
+			signal_IRQ(data_bus);
+
+			scheduler->IRQ_clock = next_IRQ_cycle(data_bus, ppu->x + 2);
+
+			continue;
+		}
+
+		if(cycle >= target)
+		{
+			break;
+		}
+
+		ppu->x = next_event_dot(data_bus);
+		scheduler->ppu_clock = scheduler->line_clock + dot_offset(ppu->x, ppu->y);
+
+		beam_events(data_bus);
+
+		if(ppu->x >= DOTS)
+		{
+			scheduler->line_clock += line_cycles(ppu->y);
+		}
+
+		advance_beam(&ppu->x, &ppu->y);
+	}
+
+	ppu->x = offset_dot(target - scheduler->line_clock, ppu->y);
+	scheduler->ppu_clock = scheduler->line_clock + dot_offset(ppu->x, ppu->y);
+
+	update_event_clock(data_bus);
+}
+
+static void run_DMA(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct DMA *dma = data_bus->B_bus.dma;
+
+	// the CPU is halted for every DMA unit, the PPU has to be caught up before each one
+	do
+	{
+		sync_PPU(data_bus, current_master_cycle(data_bus));
+		DMA_transfers(data_bus, current_master_cycle(data_bus) % 8);
+
+		cpu->queued_cyles += dma->queued_cycles;
+		dma->queued_cycles = 0;
+	} while(dma->dma_active);
+}
+
+// the lines are driven by whatever changes them, NMI_line holds an edge until it's taken
+static int take_interrupt(struct data_bus *data_bus)
+{
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	if(cpu->NMI_line == 0)
+	{
+		hw_nmi(data_bus);
+
+		return 1;
+	}
+	else if(cpu->IRQ_line == 0 && !check_bit8(cpu->cpu_status, CPU_STATUS_I))
+	{
+		hw_irq(data_bus);
+
+		return 1;
+	}
+
+	return 0;
+}
+
+static void idle(struct data_bus *data_bus)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+
+	// nothing for the CPU to do until the PPU raises something, skip to the next event. HDMA run 
+	// while halted has already taken its time out of the wait, it isn't owed by the next instruction
+	uint64_t halted_clock = scheduler->master_clock + cpu->queued_cyles;
+
+	scheduler->master_clock = scheduler->event_clock > halted_clock ? scheduler->event_clock : halted_clock;
+	cpu->queued_cyles = 0;
+
+	sync_PPU(data_bus, scheduler->master_clock + 1);
+}
+
+static void loop_state(struct Ricoh_5A22 *cpu, struct loop_state *state)
+{
+	memset(state, 0, sizeof(struct loop_state));
+
+	state->register_X = cpu->register_X;
+	state->register_Y = cpu->register_Y;
+	state->register_A = cpu->register_A;
+	state->stack_ptr = cpu->stack_ptr;
+	state->direct_page = cpu->direct_page;
+	state->program_ctr = cpu->program_ctr;
+
+	state->data_bank = cpu->data_bank;
+	state->program_bank = cpu->program_bank;
+	state->cpu_emulation6502 = cpu->cpu_emulation6502;
+	state->cpu_status = cpu->cpu_status;
+}
+
+// called after every backward jump. landing on the same head with the same registers, with nothing 
+// written, no event passed and only reads that change nothing in between, means the CPU is polling 
+// and every further pass is identical until the next event, so all the passes that fit are skipped
+static void skip_idle_loop(struct data_bus *data_bus)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	struct loop_state head;
+
+	loop_state(cpu, &head);
+
+	if(cpu->loop_clean && 
+	   cpu->loop_deadline == scheduler->event_clock && 
+	   scheduler->master_clock > cpu->loop_clock && 
+	   scheduler->event_clock > scheduler->master_clock && 
+	   memcmp(&head, &cpu->loop_head, sizeof(struct loop_state)) == 0)
+	{
+		uint64_t pass_cycles = scheduler->master_clock - cpu->loop_clock;
+
+		scheduler->master_clock += (scheduler->event_clock - scheduler->master_clock) / pass_cycles * pass_cycles;
+	}
+
+	cpu->loop_head = head;
+	cpu->loop_clock = scheduler->master_clock;
+	cpu->loop_deadline = scheduler->event_clock;
+	cpu->loop_clean = 1;
+}
+
+void run_step(struct data_bus *data_bus)
+{
+	struct Scheduler *scheduler = data_bus->scheduler;
+	struct Ricoh_5A22 *cpu = data_bus->A_Bus.cpu;
+	int backward_jump = 0;
+
+	if(cpu->LPM)
+	{
+		idle(data_bus);
+
+		return;
+	}
+
+	if(!take_interrupt(data_bus))
+	{
+		if(!cpu->RDY)
+		{
+			idle(data_bus);
+
+			return;
+		}
+
+		uint32_t instruction_addr = LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr);
+		uint8_t instruction = fetch(data_bus);
+
+		run_DMA(data_bus);
+		dispatch(data_bus, instruction);
+
+		backward_jump = LE_COMBINE_BANK_SHORT(cpu->program_bank, cpu->program_ctr) <= instruction_addr;
+	}
+
+	scheduler->master_clock += cpu->queued_cyles;
+	cpu->queued_cyles = 0;
+
+	// the PPU only has to catch up once something on it is due
+	if(scheduler->master_clock > scheduler->event_clock)
+	{
+		sync_PPU(data_bus, scheduler->master_clock);
+	}
+
+	if(cpu->REFRESH)
+	{
+		scheduler->master_clock += REFRESH_CYCLES;
+
+		cpu->REFRESH = 0;
+	}
+
+	if(backward_jump)
+	{
+		skip_idle_loop(data_bus);
+	}
+}
+
+void run_frame(struct data_bus *data_bus)
+{
+	struct PPU *ppu = data_bus->B_bus.ppu->ppu;
+
+	while(!ppu->frame_finished)
+	{
+		run_step(data_bus);
+	}
+
+	ppu->frame_finished = 0;
+}
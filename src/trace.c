@@ -0,0 +1,287 @@
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+// single producer (the thread that owns it), single consumer (the writer thread)
+struct trace_ring
+{
+	struct trace_record records[TRACE_RING_RECORDS];
+
+	_Atomic uint32_t head;
+	_Atomic uint32_t tail;
+	_Atomic uint32_t dropped;
+
+	struct trace_ring *next;
+};
+
+uint32_t trace_mask = 0;
+
+static _Thread_local struct trace_ring *thread_ring = NULL;
+
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct trace_ring *rings = NULL;
+
+static pthread_t writer;
+static atomic_int writer_running = 0;
+static atomic_int writer_stop = 0;
+static FILE *trace_file = NULL;
+
+static struct trace_ring *attach_ring(void)
+{
+	struct trace_ring *ring = calloc(1, sizeof(struct trace_ring));
+
+	if(!ring)
+	{
+		return NULL;
+	}
+
+	pthread_mutex_lock(&rings_lock);
+	ring->next = rings;
+	rings = ring;
+	pthread_mutex_unlock(&rings_lock);
+
+	return ring;
+}
+
+void trace_push(uint8_t type, uint32_t a, uint32_t b)
+{
+	struct trace_ring *ring = thread_ring;
+
+	if(!ring)
+	{
+		ring = thread_ring = attach_ring();
+
+		if(!ring)
+		{
+			return;
+		}
+	}
+
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	// never stall the emulation on a slow writer
+	if(head - tail >= TRACE_RING_RECORDS)
+	{
+		atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+
+		return;
+	}
+
+	struct trace_record *record = &ring->records[head & (TRACE_RING_RECORDS - 1)];
+
+	record->type = type;
+	record->a = a;
+	record->b = b;
+
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+static void write_record(FILE *file, struct trace_record *record)
+{
+	switch(record->type)
+	{
+		case TRACE_VRAM_ADDR:
+			fprintf(file, "NEW ADDR %04x\n", record->a);
+
+			break;
+		case TRACE_VRAM_WRITE:
+			fprintf(file, "%04x - %d%d%d%d%d%d%d%d\n",
+					record->a,
+					(record->b >> 7) & 1,
+					(record->b >> 6) & 1,
+					(record->b >> 5) & 1,
+					(record->b >> 4) & 1,
+					(record->b >> 3) & 1,
+					(record->b >> 2) & 1,
+					(record->b >> 1) & 1,
+					record->b & 1);
+
+			break;
+		case TRACE_DMA_START:
+			fprintf(file, "NEW DMA %d, %06x\n", record->b, record->a);
+
+			break;
+		case TRACE_FRAME_DRAWN:
+			fprintf(file, "DRAW\n");
+
+			break;
+		case TRACE_ROM_WRITE:
+			fprintf(file, "WRITE TO ROM: %06x\n", record->a);
+
+			break;
+		default:
+			fprintf(file, "UNKNOWN EVENT %02x %08x %08x\n", record->type, record->a, record->b);
+
+			break;
+	}
+}
+
+static int drain_rings(FILE *file)
+{
+	int drained = 0;
+
+	pthread_mutex_lock(&rings_lock);
+
+	for(struct trace_ring *ring = rings; ring; ring = ring->next)
+	{
+		uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+		uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+		for(; tail != head; tail++)
+		{
+			write_record(file, &ring->records[tail & (TRACE_RING_RECORDS - 1)]);
+			drained++;
+		}
+
+		atomic_store_explicit(&ring->tail, tail, memory_order_release);
+	}
+
+	pthread_mutex_unlock(&rings_lock);
+
+	return drained;
+}
+
+static void *run_writer(void *arg)
+{
+	FILE *file = arg;
+	struct timespec idle = { 0, 1000000 };
+
+	while(!atomic_load(&writer_stop))
+	{
+		if(!drain_rings(file))
+		{
+			nanosleep(&idle, NULL);
+		}
+	}
+
+	drain_rings(file);
+
+	return NULL;
+}
+
+uint32_t parse_trace_categories(const char *categories)
+{
+	static const struct { const char *name; uint32_t mask; } names[] =
+	{
+		{ "vram", TRACE_VRAM },
+		{ "dma", TRACE_DMA },
+		{ "frame", TRACE_FRAME },
+		{ "memory", TRACE_MEMORY },
+		{ "all", TRACE_ALL },
+	};
+
+	uint32_t mask = 0;
+	const char *name = categories;
+
+	while(*name)
+	{
+		size_t length = strcspn(name, ",");
+		int found = 0;
+
+		for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+		{
+			if(strlen(names[i].name) == length && strncmp(name, names[i].name, length) == 0)
+			{
+				mask |= names[i].mask;
+				found = 1;
+			}
+		}
+
+		if(!found)
+		{
+			printf("Unknown trace category: %.*s\n", (int)length, name);
+		}
+
+		name += length;
+
+		if(*name == ',')
+		{
+			name++;
+		}
+	}
+
+	return mask;
+}
+
+// filename NULL writes to stderr
+int start_trace(uint32_t mask, const char *filename)
+{
+	if(!TRACE)
+	{
+		printf("Failed trace: built without TRACE\n");
+
+		return 0;
+	}
+
+	trace_file = filename ? fopen(filename, "w") : stderr;
+
+	if(!trace_file)
+	{
+		printf("Failed trace: %s\n", filename);
+
+		return 0;
+	}
+
+	atomic_store(&writer_stop, 0);
+
+	if(pthread_create(&writer, NULL, run_writer, trace_file) != 0)
+	{
+		printf("Failed trace: could not start the writer\n");
+
+		if(trace_file != stderr)
+		{
+			fclose(trace_file);
+		}
+
+		trace_file = NULL;
+
+		return 0;
+	}
+
+	atomic_store(&writer_running, 1);
+	trace_mask = mask;
+
+	return 1;
+}
+
+void stop_trace(void)
+{
+	if(!atomic_load(&writer_running))
+	{
+		return;
+	}
+
+	trace_mask = 0;
+
+	atomic_store(&writer_stop, 1);
+	pthread_join(writer, NULL);
+	atomic_store(&writer_running, 0);
+
+	pthread_mutex_lock(&rings_lock);
+
+	for(struct trace_ring *ring = rings; ring; ring = ring->next)
+	{
+		uint32_t dropped = atomic_load(&ring->dropped);
+
+		if(dropped)
+		{
+			fprintf(trace_file, "%u trace events dropped\n", dropped);
+		}
+	}
+
+	pthread_mutex_unlock(&rings_lock);
+
+	if(trace_file != stderr)
+	{
+		fclose(trace_file);
+	}
+
+	trace_file = NULL;
+}
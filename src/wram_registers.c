@@ -1,51 +1,81 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "memory.h"
 #include "registers.h"
 
-void write_wram_register(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+static void write_WMDATA(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
 {
 	struct Memory *memory = data_bus->A_Bus.memory;
 
-	if(addr == WMDATA)
-	{
-		data_bus->A_Bus.memory->WRAM[memory->WRAM_addr] = write_value;
+	memory->WRAM[memory->WRAM_addr] = write_value;
+	memory->WRAM_generation[memory->WRAM_addr >> PAGE_SHIFT]++;
 
-		memory->WRAM_addr++;
-	}
+	memory->WRAM_addr = (memory->WRAM_addr + 1) & 0x0001FFFF;
+}
 
-	if(addr == WMADDL)
-	{
-		memory->WRAM_addr = memory->WRAM_addr & 0xFFFFFF00;
-		memory->WRAM_addr = memory->WRAM_addr | write_value;
-	}
+void write_WMDATA_block(struct data_bus *data_bus, const uint8_t *bytes, int count)
+{
+	struct Memory *memory = data_bus->A_Bus.memory;
 
-	if(addr == WMADDM)
+	while(count > 0)
 	{
-		memory->WRAM_addr = memory->WRAM_addr & 0xFFFF00FF;
-		memory->WRAM_addr = memory->WRAM_addr | ((0x00000000 | write_value) << 8);
-	}
+		// one page at a time so the generation counts match byte writes
+		int run = PAGE_SIZE - (memory->WRAM_addr & PAGE_MASK);
 
-	if(addr == WMADDH)
-	{
-		memory->WRAM_addr = memory->WRAM_addr & 0xFF00FFFF;
-		memory->WRAM_addr = memory->WRAM_addr | ((0x00000000 | write_value) << 16);
+		if(run > count)
+		{
+			run = count;
+		}
+
+		memcpy(&memory->WRAM[memory->WRAM_addr], bytes, run);
+		memory->WRAM_generation[memory->WRAM_addr >> PAGE_SHIFT] += run;
+
+		memory->WRAM_addr = (memory->WRAM_addr + run) & 0x0001FFFF;
+
+		bytes += run;
+		count -= run;
 	}
 }
 
-void read_wram_register(struct data_bus *data_bus, uint32_t addr)
+static void write_WMADDL(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
 {
 	struct Memory *memory = data_bus->A_Bus.memory;
 
-	if(addr == WMDATA)
-	{
-		write_register_raw(data_bus, addr, data_bus->A_Bus.memory->WRAM[memory->WRAM_addr]);
+	memory->WRAM_addr = memory->WRAM_addr & 0xFFFFFF00;
+	memory->WRAM_addr = memory->WRAM_addr | write_value;
+}
 
-		memory->WRAM_addr++;
-	}
+static void write_WMADDM(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Memory *memory = data_bus->A_Bus.memory;
+
+	memory->WRAM_addr = memory->WRAM_addr & 0xFFFF00FF;
+	memory->WRAM_addr = memory->WRAM_addr | ((0x00000000 | write_value) << 8);
+}
 
-	if(addr == WMADDL) { write_register_raw(data_bus, addr, data_bus->open_value); }
-	if(addr == WMADDM) { write_register_raw(data_bus, addr, data_bus->open_value); }
-	if(addr == WMADDH) { write_register_raw(data_bus, addr, data_bus->open_value); }
+static void write_WMADDH(struct data_bus *data_bus, uint32_t addr, uint8_t write_value)
+{
+	struct Memory *memory = data_bus->A_Bus.memory;
+
+	memory->WRAM_addr = memory->WRAM_addr & 0xFF00FFFF;
+	memory->WRAM_addr = memory->WRAM_addr | ((0x00000000 | (write_value & 0x01)) << 16);
 }
 
+static uint8_t read_WMDATA(struct data_bus *data_bus, uint32_t addr)
+{
+	struct Memory *memory = data_bus->A_Bus.memory;
+	uint8_t read = memory->WRAM[memory->WRAM_addr];
+
+	memory->WRAM_addr = (memory->WRAM_addr + 1) & 0x0001FFFF;
+
+	return read;
+}
+
+void map_wram_registers(struct Memory *memory)
+{
+	map_register(memory, WMDATA, read_WMDATA, write_WMDATA);
+	map_register(memory, WMADDL, NULL, write_WMADDL);
+	map_register(memory, WMADDM, NULL, write_WMADDM);
+	map_register(memory, WMADDH, NULL, write_WMADDH);
+}